@@ -0,0 +1,206 @@
+/**
+ * @file BoxIndex.h
+ * @brief Live index of the available boxes, keyed by region
+ * 
+ * Every box (indexed by its consignor) keeps the region and line of its last
+ * availability message and the time it was received. Every region keeps a
+ * bitmask of its boxes, so the boxes of a region are found without comparing
+ * strings. A box which did not announce itself for the expiry time is removed
+ * on the next query.
+ * 
+ * Region names are interned once into slots, slot FREE_REGION is the free
+ * region "-1" of empty boxes.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef BOXINDEX_H__
+#define BOXINDEX_H__
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Index of the available boxes
+ * 
+ * @tparam BOXES - number of box consignors, boxes of higher consignors are not indexed
+ * @tparam REGIONS - number of region slots, the free region included
+ */
+template <size_t BOXES, size_t REGIONS>
+class BoxIndex
+{
+    static_assert(BOXES > 0 && BOXES <= 32, "BoxMask is 32 bit");
+    static_assert(REGIONS > 1, "the free region needs a slot");
+
+    //======================PUBLIC===========================================================
+    public:
+
+    typedef uint32_t BoxMask;                   ///< set of boxes, bit n is the box with consignor n
+
+    static const size_t FREE_REGION = 0;        ///< slot of the free region "-1"
+    static const size_t NO_REGION = REGIONS;    ///< slot of a region which did not fit into the index
+
+    /**
+     * @brief Construct a new Box Index object
+     * 
+     * @param expiry - time in ms a box stays available after its last message
+     */
+    explicit BoxIndex(unsigned long expiry) : expiry(expiry)
+    {
+        regions[FREE_REGION].name = "-1";
+        regions[FREE_REGION].used = true;
+    }
+
+    /**
+     * @brief Get the slot of a region, the region is interned on first use
+     * 
+     * @param name - name of the region, "-1" for the free region
+     * @return size_t - slot of the region, NO_REGION if all slots are used
+     */
+    size_t region(const String &name)
+    {
+        for (size_t i = 0; i < REGIONS; i++)
+        {
+            if (!regions[i].used)
+            {
+                regions[i].name = name;
+                regions[i].used = true;
+                return i;
+            }
+            if (regions[i].name == name)
+            {
+                return i;
+            }
+        }
+        return NO_REGION;
+    }
+
+    /**
+     * @brief Store an availability message of a box
+     * 
+     * @param box - consignor of the box
+     * @param name - region the box collects, "-1" if the box is free
+     * @param line - line of the box
+     * @param now - time in ms
+     */
+    void update(size_t box, const String &name, int line, unsigned long now)
+    {
+        if (box >= BOXES)
+        {
+            return;
+        }
+        Box &entry = boxes[box];
+        size_t slot = entry.valid && regions[entry.region].name == name ? entry.region : region(name);
+        remove(box);
+        if (slot == NO_REGION)
+        {
+            return;
+        }
+        entry.region = slot;
+        entry.line = line;
+        entry.seen = now;
+        entry.valid = true;
+        regions[slot].boxes |= (BoxMask)1 << box;
+    }
+
+    /**
+     * @brief Remove a box from the index
+     * 
+     * @param box - consignor of the box
+     */
+    void remove(size_t box)
+    {
+        if (box >= BOXES || !boxes[box].valid)
+        {
+            return;
+        }
+        regions[boxes[box].region].boxes &= ~((BoxMask)1 << box);
+        boxes[box].valid = false;
+    }
+
+    /**
+     * @brief Get the available boxes of a region, expired boxes are removed
+     * 
+     * @param slot - slot of the region
+     * @param now - time in ms
+     * @return BoxMask
+     */
+    BoxMask available(size_t slot, unsigned long now)
+    {
+        if (slot >= REGIONS)
+        {
+            return 0;
+        }
+        BoxMask mask = regions[slot].boxes;
+        for (size_t box = 0; box < BOXES; box++)
+        {
+            if ((mask >> box & 1) && now - boxes[box].seen > expiry)
+            {
+                remove(box);
+            }
+        }
+        return regions[slot].boxes;
+    }
+
+    /**
+     * @brief Check whether any box of any region is available, expired boxes are removed
+     * 
+     * @param now - time in ms
+     * @return true
+     * @return false
+     */
+    bool any(unsigned long now)
+    {
+        bool found = false;
+        for (size_t i = 0; i < REGIONS && regions[i].used; i++)
+        {
+            found = available(i, now) != 0 || found;
+        }
+        return found;
+    }
+
+    /**
+     * @brief Get the line of an indexed box
+     * 
+     * @param box - consignor of the box
+     * @return int
+     */
+    int line(size_t box) const { return box < BOXES ? boxes[box].line : 0; }
+
+    //======================PRIVATE==========================================================
+    private:
+
+    /**
+     * @brief Last availability message of a box
+     * 
+     */
+    struct Box
+    {
+        size_t region = 0;              ///< slot of the region the box collects
+        int line = 0;                   ///< line of the box
+        unsigned long seen = 0;         ///< time of the last message
+        bool valid = false;             ///< box is in the index
+    };
+
+    /**
+     * @brief Interned region and its boxes
+     * 
+     */
+    struct Region
+    {
+        String name;                    ///< name of the region
+        BoxMask boxes = 0;              ///< boxes which collect the region
+        bool used = false;              ///< slot is interned
+    };
+
+    const unsigned long expiry;         ///< time in ms a box stays available after its last message
+    Box boxes[BOXES];                   ///< last message of every box
+    Region regions[REGIONS];            ///< interned regions
+};
+
+#endif // BOXINDEX_H__
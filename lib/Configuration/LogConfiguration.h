@@ -6,6 +6,12 @@
  * @author Luca Mazzoleni (luca.mazzoleni@hsr.ch)
  * 
  * @version 1.0 -  Implement diffrent debug functions - Luca Mazzoleni (luca.mazzoleni@hsr.ch)  - 2019-03-20
+ * @version 1.1 -  Deferred trace backend TRACE_LOG, DEBUGGER really switches the macros off - 2026-10-16
+ * 
+ * Every level is switched at compile time, a macro of a disabled level is
+ * empty. An enabled level prints on Serial, or with TRACE_LOG it stores a
+ * record in the TraceLog ring, which the CommunicationHub drains when it is
+ * about to sleep or publishes on demand. With TRACE_LOG the macros take string literals only, see TraceLog.h.
  * 
  * @date 2019-03-20
  * @copyright Copyright (c) 2019
@@ -15,7 +21,18 @@
 #ifndef LOGCONFIGURATION_H
 #define LOGCONFIGURATION_H
 
-#define DEBUGGER false  ///< Option to activate the Serial.print global
+// #define DEBUGGER     ///< Option to activate the logging macros global
+// #define TRACE_LOG    ///< Store the logging macros as binary records in the TraceLog ring instead of printing them, needs DEBUGGER
+
+#define TRACE_LOG_SIZE 128          ///< number of records of the TraceLog ring, a power of two
+#define TRACE_DRAIN_BATCH 16        ///< records printed at most per idle pass of the CommunicationHub
+#define TRACE_PUBLISH_SIZE 512      ///< size of one mqtt payload of CommunicationHub::publishTrace(), a payload holds whole lines
+#define TRACE_OWNER "hub"           ///< owner of the trace topic, Sortic/hub/trace
+
+#ifdef TRACE_LOG
+#include "TraceLog.h"
+extern TraceLog<TRACE_LOG_SIZE> traceLog;   ///< records of all logging macros
+#endif
 
 #ifdef DEBUGGER
 #define DEBUG_ERROR     ///< Define DEBUG_ERROR global to print all  occuring errors via serial
@@ -28,7 +45,9 @@
 #define DEBUG_FUNCCALL  ///< Define DEBUG_FUNCCALL global to print all occuring functioncalls via serial
 #endif
 
-#ifdef DEBUG_ERROR
+#if defined(DEBUG_ERROR) && defined(TRACE_LOG)
+#define DBERROR(x) traceLog.record(TraceLevel::Error, x);
+#elif defined(DEBUG_ERROR)
 #define DBERROR(x)           \
     Serial.print("ERROR: "); \
     Serial.println(x);
@@ -36,15 +55,26 @@
 #define DBERROR(x)
 #endif
 
-#ifdef DEBUG_WARNING
+#if defined(DEBUG_WARNING) && defined(TRACE_LOG)
+#define DBWARNING(x) traceLog.record(TraceLevel::Warning, x)
+#define DBWARNINGln(x) traceLog.record(TraceLevel::Warning, x)
+#define DBWARNINGVALln(x, value) traceLog.record(TraceLevel::Warning, x, value)
+#elif defined(DEBUG_WARNING)
 #define DBWARNING(x) Serial.print(x)
 #define DBWARNINGln(x) Serial.println(x)
+#define DBWARNINGVALln(x, value) \
+    Serial.print(x);             \
+    Serial.println(value);
 #else
 #define DBWARNING(x)
 #define DBWARNINGln(x)
+#define DBWARNINGVALln(x, value)
 #endif
 
-#ifdef DEBUG_STATUS
+#if defined(DEBUG_STATUS) && defined(TRACE_LOG)
+#define DBSTATUS(x) traceLog.record(TraceLevel::Status, x)
+#define DBSTATUSln(x) traceLog.record(TraceLevel::Status, x)
+#elif defined(DEBUG_STATUS)
 #define DBSTATUS(x) Serial.print(x)
 #define DBSTATUSln(x) Serial.println(x)
 #else
@@ -52,15 +82,26 @@
 #define DBSTATUSln(x)
 #endif
 
-#ifdef DEBUG_EVENT
+#if defined(DEBUG_EVENT) && defined(TRACE_LOG)
+#define DBEVENT(x) traceLog.record(TraceLevel::Event, x)
+#define DBEVENTln(x) traceLog.record(TraceLevel::Event, x)
+#define DBEVENTVALln(x, value) traceLog.record(TraceLevel::Event, x, value)
+#elif defined(DEBUG_EVENT)
 #define DBEVENT(x) Serial.print(x)
 #define DBEVENTln(x) Serial.println(x)
+#define DBEVENTVALln(x, value) \
+    Serial.print(x);           \
+    Serial.println(value);
 #else
 #define DBEVENT(x)
 #define DBEVENTln(x)
+#define DBEVENTVALln(x, value)
 #endif
 
-#ifdef DEBUG_INFO1
+#if defined(DEBUG_INFO1) && defined(TRACE_LOG)
+#define DBINFO1(x) traceLog.record(TraceLevel::Info1, x);
+#define DBINFO1ln(x) traceLog.record(TraceLevel::Info1, x);
+#elif defined(DEBUG_INFO1)
 #define DBINFO1(x)       \
     if (Serial) {        \
         Serial.print(x); \
@@ -74,7 +115,10 @@
 #define DBINFO1ln(x)
 #endif
 
-#ifdef DEBUG_INFO2
+#if defined(DEBUG_INFO2) && defined(TRACE_LOG)
+#define DBINFO2(x) traceLog.record(TraceLevel::Info2, x);
+#define DBINFO2ln(x) traceLog.record(TraceLevel::Info2, x);
+#elif defined(DEBUG_INFO2)
 #define DBINFO2(x)       \
     if (Serial) {        \
         Serial.print(x); \
@@ -88,7 +132,10 @@
 #define DBINFO2ln(x)
 #endif
 
-#ifdef DEBUG_INFO3
+#if defined(DEBUG_INFO3) && defined(TRACE_LOG)
+#define DBINFO3(x) traceLog.record(TraceLevel::Info3, x);
+#define DBINFO3ln(x) traceLog.record(TraceLevel::Info3, x);
+#elif defined(DEBUG_INFO3)
 #define DBINFO3(x)       \
     if (Serial) {        \
         Serial.print(x); \
@@ -102,7 +149,10 @@
 #define DBINFO3ln(x)
 #endif
 
-#ifdef DEBUG_FUNCCALL
+#if defined(DEBUG_FUNCCALL) && defined(TRACE_LOG)
+#define DBFUNCCALL(x) traceLog.record(TraceLevel::FuncCall, x)
+#define DBFUNCCALLln(x) traceLog.record(TraceLevel::FuncCall, x)
+#elif defined(DEBUG_FUNCCALL)
 #define DBFUNCCALL(x)    \
     if (Serial) {        \
         Serial.print(x); \
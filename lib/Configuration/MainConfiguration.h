@@ -12,16 +12,66 @@
 #ifndef MAINCONFIGURATION_H__
 #define MAINCONFIGURATION_H__
 
-#include <deque>
 #include <memory>
 #include "MessageTranslation.h"
 
 #define Master
 #define I2CMASTERADDRESP 33                 ///< I2C adress of master
-#define I2CSLAVEADDRUNO 7                   ///< I2C adress of slave
+#define I2CSLAVEADDRUNO 7                   ///< I2C adress of the slave of the first sortic, the following sortics use the next addresses
+// #define I2C_BINARY_PROTOCOL              ///< exchange I2cFrame with the slave instead of padded string events, needs slave support
+// #define PIPELINED_PACKAGES               ///< negotiate the box of the next package while the current one waits for its box
+// #define HUB_METRICS                      ///< keep latency histograms of the states, do-actions and i/o calls and publish them on Sortic/<id>/metrics
+#define BINARY_WIRE_TOPICS 0                ///< TopicKind bits of the topics published in CBOR, e.g. (1 << (int)TopicKind::SorticHandshake), the receivers must read CBOR
 
 #define DEFAULT_HOSTNAME "Sortic"           ///< Hostname
-#define TIME_BETWEEN_PUBLISH 300            ///< Time between publish
-#define TIME_BETWEEN_SUBSCRIBE 5000         ///< Time between subscribe
+#define SORTIC_ID_PREFIX "SO"               ///< Consignor id of a sortic in topics and handshakes is the prefix and its number, e.g. "SO1"
+#ifndef SORTIC_COUNT
+#define SORTIC_COUNT 1                      ///< Maximum number of sortic roboters hosted by the hub
+#endif
+#define TIME_BETWEEN_PUBLISH 300            ///< Time between publish, the handshake starts with it and doubles it on every retry
+#define HANDSHAKE_BACKOFF_MAX 5000          ///< Upper limit of the time between two handshake messages, a random part of up to half of it is left out
+#define HANDSHAKE_RETRIES 4                 ///< Number of times a handshake message is published again before the box counts as not answering
+#define TIME_BETWEEN_SUBSCRIBE 5000         ///< Time window to collect available boxes
+#define BOX_SCORE_REGION 1000               ///< Score of a box which collects the target region of the package
+#define BOX_SCORE_FREE 500                  ///< Score of a free box, it can take any region
+#define BOX_SCORE_PENDING 100               ///< Penalty of a free box for every package of another region which waits for a box
+#define BOX_SCORE_LINE 10                   ///< Penalty for every line between the sortic and the box
+#define BOX_SCORE_FILL 20                   ///< Penalty for every package the hub sorted into the box
+#define BOX_SCORE_FILL_MAX 10               ///< Sorted packages after which the fill penalty stops growing, a full box does not answer at all
+#define BOX_CONSIGNORS 8                    ///< Number of box consignors the hub indexes and counts the sorted packages of
+#define BOX_REGIONS 8                       ///< Number of regions in the box availability index, the free region included
+#define BOX_AVAILABLE_EXPIRY 10000          ///< Time a box stays in the availability index after its last available message
+#define HANDSHAKE_CANDIDATES 1              ///< Number of best boxes the handshake requests at once, the first box which answers wins
+#define HANDSHAKE_RELEASE "release"         ///< Acknowledge of a handshake message which releases a requested box
+#define ARRIVALS_IN_FLIGHT 4                ///< Number of delivered packages of a sortic which wait for their box at once
+#define ARRIVAL_TIMEOUT 30000               ///< Time a delivered package waits for the confirmation of its box
+#define I2C_POLL_INTERVAL 400               ///< Time between i2c requests to the slave in idle
+#define MQTT_POLL_INTERVAL 400              ///< Time between mqtt checks in idle
+#define MQTT_POLL_INTERVAL_BUSY 1           ///< Time between mqtt checks while a state waits for messages
+#define MQTT_PROBE_INTERVAL 5000            ///< Time between two probes of the subscriptions, a probe the broker did not echo until the next one resubscribes all topics
+#define MQTT_PROBE_OWNER "hub"              ///< Owner of the probe topic of the hub, Sortic/hub/probe
+#define PUBLISH_COALESCE_WINDOW 250         ///< Time a changed status or position of the roboter is held back, only the latest value of it is published
+#define METRICS_INTERVAL 10000              ///< Time between two metrics snapshots, every snapshot covers the time since the last one
+#define METRICS_BUCKETS 16                  ///< Number of power of two buckets of a latency histogram, the last one is open
+#define METRICS_MAX_SIZE 1024               ///< Size of the encoded metrics snapshot, a longer snapshot is not published
+#define METRICS_HUB_OWNER "hub"             ///< Owner of the metrics topic of the hub, Sortic/hub/metrics
+
+// #define DUAL_CORE                        ///< run the mqtt client in its own task on the other core, messages pass through lock-free queues
+#define MQTT_TASK_CORE 0                    ///< Core of the mqtt task, the Arduino loop runs on core 1
+#define MQTT_TASK_STACK 8192                ///< Stack size of the mqtt task
+#define MQTT_TASK_PERIOD 1                  ///< Time between two passes of the mqtt task
+#define MQTT_INBOX_SIZE 16                  ///< Capacity of the queue of received messages from the mqtt task
+#define MQTT_COMMAND_QUEUE_SIZE 16          ///< Capacity of the queue of publish and subscribe requests to the mqtt task
+
+#define DUPLICATE_FILTER_CONSIGNORS 8       ///< Number of consignors tracked by the duplicate filter
+#define DUPLICATE_FILTER_TYPES 16           ///< Number of message types tracked by the duplicate filter
+
+#define TOPIC_TABLE_SIZE (7 * SORTIC_COUNT + 20)     ///< Number of interned mqtt topics, seven per sortic, the topics of the boxes and the metrics, probe and trace of the hub
+#define TOPIC_TABLE_LENGTH 32               ///< Reserved length of an interned mqtt topic
+
+#define ERROR_BUFFER_SIZE 4                 ///< Capacity of the error message buffer, further errors are dropped
+#define SBSTATE_BUFFER_SIZE 4               ///< Capacity of the box state buffer, the oldest message is dropped
+#define HANDSHAKE_BUFFER_SIZE 4             ///< Capacity of the handshake buffer, the oldest message is dropped
+#define SOBUFFER_BUFFER_SIZE 4              ///< Capacity of the sortic buffer message buffer, the oldest message is dropped
 
 #endif // MAINCONFIGURATION_H__
\ No newline at end of file
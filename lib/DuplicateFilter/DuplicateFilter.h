@@ -0,0 +1,132 @@
+/**
+ * @file DuplicateFilter.h
+ * @brief Constant time detection of duplicated messages
+ * 
+ * Every sender (consignor and message type) gets a sliding window over its
+ * message ids: the highest id seen so far and a bitmap of the
+ * DUPLICATE_FILTER_WINDOW ids below it. An id is answered in O(1), independent
+ * of how many messages are buffered.
+ * 
+ * An id further below the window than DUPLICATE_FILTER_WINDOW is taken as a
+ * restart of the sender (its id counter began again at 0) and resets the window.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef DUPLICATEFILTER_H__
+#define DUPLICATEFILTER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DUPLICATE_FILTER_WINDOW 64          ///< number of ids tracked below the highest id
+
+/**
+ * @brief Sliding window duplicate filter keyed by consignor and message type
+ * 
+ * @tparam CONSIGNORS - number of consignors, ids of higher consignors are not filtered
+ * @tparam TYPES - number of message types, ids of higher types are not filtered
+ */
+template <size_t CONSIGNORS, size_t TYPES>
+class DuplicateFilter
+{
+    //======================PUBLIC===========================================================
+    public:
+
+    /**
+     * @brief Check a message id and remember it
+     * 
+     * @param consignor - consignor of the message
+     * @param type - type of the message
+     * @param id - id of the message
+     * @return true - id was seen before, message is dropped
+     * @return false - new id
+     */
+    bool isDuplicate(size_t consignor, size_t type, unsigned long long id)
+    {
+        if (consignor >= CONSIGNORS || type >= TYPES)
+        {
+            return false;
+        }
+        Window &window = windows[consignor][type];
+        if (!window.valid || id + DUPLICATE_FILTER_WINDOW <= window.top)
+        {
+            if (window.valid)
+            {
+                restarts++;
+            }
+            window.valid = true;
+            window.top = id;
+            window.seen = 1;
+            return false;
+        }
+        if (id > window.top)
+        {
+            unsigned long long shift = id - window.top;
+            window.seen = shift < DUPLICATE_FILTER_WINDOW ? (window.seen << shift) | 1 : 1;
+            window.top = id;
+            return false;
+        }
+        uint64_t bit = (uint64_t)1 << (window.top - id);
+        if (window.seen & bit)
+        {
+            dropped++;
+            return true;
+        }
+        window.seen |= bit;
+        return false;
+    }
+
+    /**
+     * @brief Forget all seen ids
+     * 
+     */
+    void clear()
+    {
+        for (size_t c = 0; c < CONSIGNORS; c++)
+        {
+            for (size_t t = 0; t < TYPES; t++)
+            {
+                windows[c][t] = Window();
+            }
+        }
+    }
+
+    /**
+     * @brief Get the number of dropped duplicates
+     * 
+     * @return unsigned long 
+     */
+    unsigned long getDropped() const { return dropped; }
+
+    /**
+     * @brief Get the number of detected sender restarts
+     * 
+     * @return unsigned long 
+     */
+    unsigned long getRestarts() const { return restarts; }
+
+    //======================PRIVATE==========================================================
+    private:
+
+    /**
+     * @brief Sliding window of one sender
+     * 
+     */
+    struct Window
+    {
+        unsigned long long top = 0;     ///< highest id seen
+        uint64_t seen = 0;              ///< bit n set: id top - n seen
+        bool valid = false;             ///< an id was seen
+    };
+
+    Window windows[CONSIGNORS][TYPES];  ///< windows of all senders
+    unsigned long dropped = 0;          ///< number of dropped duplicates
+    unsigned long restarts = 0;         ///< number of detected sender restarts
+};
+
+#endif // DUPLICATEFILTER_H__
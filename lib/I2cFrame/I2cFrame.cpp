@@ -0,0 +1,129 @@
+/**
+ * @file I2cFrame.cpp
+ * @brief Binary frame of the i2c protocol between the communication hub and the Sortic roboter
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "I2cFrame.h"
+
+#include <string.h>
+
+#define LEGACY_EVENT_LENGTH 11              ///< length of the padded string events
+
+/**
+ * @brief Padded string events of the former protocol, indexed by opcode
+ * 
+ */
+static constexpr char legacyEvents[I2C_OPCODE_COUNT][LEGACY_EVENT_LENGTH + 1] = 
+{
+    "null#######",
+    "PublishSTA#",
+    "PublishPOS#",
+    "PublishPAC#",
+    "PublishERR#",
+    "PublishINI#",
+    "BoxComm####",
+    "ArrivConf##",
+    "SortPackage",
+    "PackageArri",
+    "null#######"
+};
+
+#define LEGACY_SLOTS 32                     ///< number of slots of legacySlots, a power of two
+
+/**
+ * @brief Slot of a padded string event, character 2 and 8 differ in every pair of events
+ * 
+ */
+static constexpr uint8_t legacySlot(const char *event)
+{
+    return (uint8_t)((event[2] ^ event[8]) & (LEGACY_SLOTS - 1));
+}
+
+/**
+ * @brief Opcode of the only event in a slot, Invalid for an empty slot
+ * 
+ */
+static constexpr uint8_t legacySlots[LEGACY_SLOTS] =
+{
+    10, 10, 10,  3, 10, 10, 10, 10, 10, 10, 10, 10,  5,  2, 10,  0,
+     4,  9, 10,  8,  7, 10,  1, 10, 10, 10, 10,  6, 10, 10, 10, 10
+};
+
+/**
+ * @brief Check at compile time that every event is found in its slot
+ * 
+ */
+static constexpr bool isLegacySlotted(size_t opcode)
+{
+    return opcode == (size_t)I2cOpcode::Invalid ||
+           (legacySlots[legacySlot(legacyEvents[opcode])] == opcode && isLegacySlotted(opcode + 1));
+}
+
+static_assert(isLegacySlotted(0), "legacySlots needs the opcode of every legacy event in its slot");
+
+void I2cFrame::encode(const I2cFrame &frame, uint8_t *buffer)
+{
+    buffer[0] = I2C_FRAME_VERSION;
+    buffer[1] = (uint8_t)frame.opcode;
+    buffer[2] = frame.state;
+    buffer[3] = frame.position;
+    buffer[4] = (uint8_t)(frame.packageId & 0xFF);
+    buffer[5] = (uint8_t)(frame.packageId >> 8);
+    buffer[6] = frame.targetDest;
+    buffer[7] = (frame.error ? 0x01 : 0x00) | (frame.token ? 0x02 : 0x00);
+    buffer[8] = frame.targetLine;
+    buffer[9] = crc8(buffer, I2C_FRAME_SIZE - 1);
+}
+
+bool I2cFrame::decode(const uint8_t *buffer, I2cFrame &frame)
+{
+    if (buffer[0] != I2C_FRAME_VERSION || buffer[9] != crc8(buffer, I2C_FRAME_SIZE - 1))
+    {
+        return false;
+    }
+    frame.opcode = buffer[1] < (uint8_t)I2cOpcode::Invalid ? (I2cOpcode)buffer[1] : I2cOpcode::Invalid;
+    frame.state = buffer[2];
+    frame.position = buffer[3];
+    frame.packageId = (uint16_t)(buffer[4] | (buffer[5] << 8));
+    frame.targetDest = buffer[6];
+    frame.error = buffer[7] & 0x01;
+    frame.token = buffer[7] & 0x02;
+    frame.targetLine = buffer[8];
+    return true;
+}
+
+uint8_t I2cFrame::crc8(const uint8_t *data, size_t length)
+{
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+I2cOpcode I2cFrame::decodeLegacyEvent(const char *event)
+{
+    // the slot names the only candidate, one compare confirms it
+    uint8_t opcode = legacySlots[legacySlot(event)];
+    if (opcode < (uint8_t)I2cOpcode::Invalid && !memcmp(event, legacyEvents[opcode], LEGACY_EVENT_LENGTH))
+    {
+        return (I2cOpcode)opcode;
+    }
+    return I2cOpcode::Invalid;
+}
+
+const char *I2cFrame::encodeLegacyEvent(I2cOpcode opcode)
+{
+    return (size_t)opcode < I2C_OPCODE_COUNT ? legacyEvents[(size_t)opcode] : legacyEvents[(size_t)I2cOpcode::Invalid];
+}
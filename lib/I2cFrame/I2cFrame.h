@@ -0,0 +1,117 @@
+/**
+ * @file I2cFrame.h
+ * @brief Binary frame of the i2c protocol between the communication hub and the Sortic roboter
+ * 
+ * Layout of version 1 (I2C_FRAME_SIZE bytes, same in both directions):
+ * 
+ * | byte | content                          |
+ * |------|----------------------------------|
+ * | 0    | version                          |
+ * | 1    | opcode                           |
+ * | 2    | state of the sortic roboter      |
+ * | 3    | position of the sortic roboter   |
+ * | 4-5  | package id, little endian        |
+ * | 6    | target destination               |
+ * | 7    | flags: bit 0 error, bit 1 token  |
+ * | 8    | target line                      |
+ * | 9    | CRC-8 (poly 0x07) of byte 0 - 8  |
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef I2CFRAME_H__
+#define I2CFRAME_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define I2C_FRAME_VERSION 1                 ///< version of the frame layout
+#define I2C_FRAME_SIZE 10                   ///< size of a frame in bytes
+
+/**
+ * @brief Enum class holds the opcodes of the i2c protocol
+ * 
+ */
+enum class I2cOpcode : uint8_t
+{
+    Null,                   ///< no event, legacy "null#######"
+    PublishState,           ///< legacy "PublishSTA#"
+    PublishPosition,        ///< legacy "PublishPOS#"
+    PublishPackage,         ///< legacy "PublishPAC#"
+    PublishError,           ///< legacy "PublishERR#"
+    PublishInit,            ///< legacy "PublishINI#"
+    BoxCommunication,       ///< legacy "BoxComm####"
+    ArrivConfirmation,      ///< legacy "ArrivConf##"
+    SortPackage,            ///< legacy "SortPackage"
+    PackageArrived,         ///< legacy "PackageArri"
+    Invalid                 // keep last, unknown event
+};
+
+#define I2C_OPCODE_COUNT ((size_t)I2cOpcode::Invalid + 1)    ///< number of opcodes
+
+/**
+ * @brief Frame of the i2c protocol
+ * 
+ */
+struct I2cFrame
+{
+    I2cOpcode opcode = I2cOpcode::Null;     ///< event
+    uint8_t state = 0;                      ///< state of the sortic roboter
+    uint8_t position = 0;                   ///< position of the sortic roboter
+    uint16_t packageId = 0;                 ///< package id
+    uint8_t targetDest = 0;                 ///< target destination of the package
+    bool error = false;                     ///< error flag
+    bool token = false;                     ///< error token
+    uint8_t targetLine = 0;                 ///< target line of the package
+
+    /**
+     * @brief Serialize the frame
+     * 
+     * @param frame - frame to serialize
+     * @param buffer - I2C_FRAME_SIZE bytes
+     */
+    static void encode(const I2cFrame &frame, uint8_t *buffer);
+
+    /**
+     * @brief Deserialize a frame
+     * 
+     * - opcodes above Invalid are decoded as Invalid
+     * 
+     * @param buffer - I2C_FRAME_SIZE bytes
+     * @param frame - deserialized frame
+     * @return true - version and CRC are correct
+     * @return false - frame rejected, frame is unchanged
+     */
+    static bool decode(const uint8_t *buffer, I2cFrame &frame);
+
+    /**
+     * @brief CRC-8 with polynomial 0x07
+     * 
+     * @param data 
+     * @param length 
+     * @return uint8_t 
+     */
+    static uint8_t crc8(const uint8_t *data, size_t length);
+
+    /**
+     * @brief Decodes a padded string event of the former string protocol by table lookup
+     * 
+     * @param event - e.g. "PublishSTA#"
+     * @return I2cOpcode - Invalid if unknown
+     */
+    static I2cOpcode decodeLegacyEvent(const char *event);
+
+    /**
+     * @brief Encodes an opcode to the padded string event of the former string protocol
+     * 
+     * @param opcode 
+     * @return const char* - 11 characters, "null#######" for Invalid
+     */
+    static const char *encodeLegacyEvent(I2cOpcode opcode);
+};
+
+#endif // I2CFRAME_H__
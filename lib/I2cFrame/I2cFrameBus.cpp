@@ -0,0 +1,60 @@
+/**
+ * @file I2cFrameBus.cpp
+ * @brief I2c master which exchanges I2cFrame with the Sortic roboter
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "I2cFrameBus.h"
+
+#include <Wire.h>
+
+I2cFrameBus::I2cFrameBus(int slaveAddress, ReceivedI2cMessage *pReceivedMessage, WriteI2cMessage *pWriteMessage)
+    : slaveAddress(slaveAddress), pReceivedMessage(pReceivedMessage), pWriteMessage(pWriteMessage)
+{
+    Wire.begin();
+}
+
+void I2cFrameBus::readMessage()
+{
+    uint8_t buffer[I2C_FRAME_SIZE];
+    size_t length = 0;
+    Wire.requestFrom((uint8_t)slaveAddress, (uint8_t)I2C_FRAME_SIZE);
+    while (Wire.available() && length < I2C_FRAME_SIZE)
+    {
+        buffer[length++] = (uint8_t)Wire.read();
+    }
+
+    I2cFrame frame;
+    if (length != I2C_FRAME_SIZE || !I2cFrame::decode(buffer, frame))
+    {
+        rejectedFrames++;
+        receivedOpcode = I2cOpcode::Null;
+        return;
+    }
+    receivedOpcode = frame.opcode;
+    pReceivedMessage->state = frame.state;
+    pReceivedMessage->position = frame.position;
+    pReceivedMessage->packageId = frame.packageId;
+    pReceivedMessage->targetDest = frame.targetDest;
+    pReceivedMessage->error = frame.error;
+    pReceivedMessage->token = frame.token;
+}
+
+void I2cFrameBus::writeMessage()
+{
+    I2cFrame frame;
+    frame.opcode = writeOpcode;
+    frame.targetLine = pWriteMessage->targetLine;
+    frame.packageId = writePackageId;
+
+    uint8_t buffer[I2C_FRAME_SIZE];
+    I2cFrame::encode(frame, buffer);
+    Wire.beginTransmission((uint8_t)slaveAddress);
+    Wire.write(buffer, I2C_FRAME_SIZE);
+    Wire.endTransmission();
+}
@@ -0,0 +1,90 @@
+/**
+ * @file I2cFrameBus.h
+ * @brief I2c master which exchanges I2cFrame with the Sortic roboter
+ * 
+ * Drop-in for I2cCommunication: it fills the same ReceivedI2cMessage and sends
+ * the same WriteI2cMessage, but the event travels as opcode in an I2cFrame.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef I2CFRAMEBUS_H__
+#define I2CFRAMEBUS_H__
+
+#include "I2cCommunication.h"
+#include "I2cFrame.h"
+
+/**
+ * @brief I2c master for the binary frame protocol
+ * 
+ */
+class I2cFrameBus
+{
+    public:
+
+    /**
+     * @brief Construct a new I2c Frame Bus object
+     * 
+     * @param slaveAddress - i2c address of the slave
+     * @param pReceivedMessage - filled by readMessage()
+     * @param pWriteMessage - sent by writeMessage()
+     */
+    I2cFrameBus(int slaveAddress, ReceivedI2cMessage *pReceivedMessage, WriteI2cMessage *pWriteMessage);
+
+    /**
+     * @brief Request a frame from the slave
+     * 
+     * - a rejected frame (size, version, CRC) reads as I2cOpcode::Null
+     * 
+     */
+    void readMessage();
+
+    /**
+     * @brief Send the write message with the write opcode to the slave
+     * 
+     */
+    void writeMessage();
+
+    /**
+     * @brief Get the opcode of the last read frame
+     * 
+     * @return I2cOpcode 
+     */
+    I2cOpcode getReceivedOpcode() const { return receivedOpcode; }
+
+    /**
+     * @brief Set the opcode of the next write
+     * 
+     * @param opcode 
+     */
+    void setWriteOpcode(I2cOpcode opcode) { writeOpcode = opcode; }
+
+    /**
+     * @brief Set the package id of the next write
+     * 
+     * @param packageId 
+     */
+    void setWritePackageId(uint16_t packageId) { writePackageId = packageId; }
+
+    /**
+     * @brief Get the number of rejected frames
+     * 
+     * @return unsigned long 
+     */
+    unsigned long getRejectedFrames() const { return rejectedFrames; }
+
+    private:
+    int slaveAddress;                               ///< i2c address of the slave
+    ReceivedI2cMessage *pReceivedMessage;           ///< target of read frames
+    WriteI2cMessage *pWriteMessage;                 ///< source of write frames
+    I2cOpcode receivedOpcode = I2cOpcode::Null;     ///< opcode of the last read frame
+    I2cOpcode writeOpcode = I2cOpcode::Null;        ///< opcode of the next write frame
+    uint16_t writePackageId = 0;                    ///< package id of the next write frame
+    unsigned long rejectedFrames = 0;               ///< number of rejected frames
+};
+
+#endif // I2CFRAMEBUS_H__
@@ -0,0 +1,123 @@
+/**
+ * @file LatencyHistogram.h
+ * @brief Fixed-bucket histogram of durations with power of two bucket bounds
+ *
+ * Bucket 0 counts the value 0, bucket i the values from 2^(i-1) to 2^i - 1,
+ * the last bucket everything above. Adding a value costs a few shifts and
+ * never allocates, so it can be called on every pass of the loop. The unit
+ * is the one of the added values, us for calls and ms for states.
+ *
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#ifndef LATENCYHISTOGRAM_H__
+#define LATENCYHISTOGRAM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Fixed-bucket histogram of durations
+ *
+ * @tparam BUCKETS - number of buckets, the last one is open
+ */
+template <size_t BUCKETS>
+class LatencyHistogram
+{
+    static_assert(BUCKETS >= 2 && BUCKETS <= 33, "LatencyHistogram needs 2 to 33 buckets");
+
+    //======================PUBLIC===========================================================
+    public:
+
+    /**
+     * @brief Count a duration
+     *
+     * @param value - duration
+     */
+    void add(unsigned long value)
+    {
+        size_t bucket = 0;
+        for (unsigned long rest = value; rest != 0 && bucket < BUCKETS - 1; rest >>= 1)
+        {
+            bucket++;
+        }
+        counts[bucket]++;
+        count++;
+        sum += value;
+        max = value > max ? value : max;
+    }
+
+    /**
+     * @brief Get the number of buckets up to the last one with values
+     *
+     * @return size_t - 0 without values
+     */
+    size_t usedBuckets() const
+    {
+        size_t used = BUCKETS;
+        while (used > 0 && counts[used - 1] == 0)
+        {
+            used--;
+        }
+        return used;
+    }
+
+    /**
+     * @brief Get the number of values
+     *
+     * @return uint32_t
+     */
+    uint32_t getCount() const { return count; }
+
+    /**
+     * @brief Write the histogram as CBOR array [name, count, sum, max, [buckets up to the last one with values]]
+     *
+     * @tparam Writer - CborWriter
+     * @param writer - receives the array
+     * @param name - name of the histogram
+     */
+    template <typename Writer>
+    void write(Writer &writer, const char *name) const
+    {
+        size_t used = usedBuckets();
+        writer.head(Writer::ARRAY, 5);
+        writer.text(name);
+        writer.head(Writer::UNSIGNED, count);
+        writer.head(Writer::UNSIGNED, sum);
+        writer.head(Writer::UNSIGNED, max);
+        writer.head(Writer::ARRAY, used);
+        for (size_t i = 0; i < used; i++)
+        {
+            writer.head(Writer::UNSIGNED, counts[i]);
+        }
+    }
+
+    /**
+     * @brief Forget all values, call after a snapshot was taken
+     *
+     */
+    void reset()
+    {
+        for (size_t i = 0; i < BUCKETS; i++)
+        {
+            counts[i] = 0;
+        }
+        count = 0;
+        sum = 0;
+        max = 0;
+    }
+
+    //======================PRIVATE==========================================================
+    private:
+
+    uint32_t counts[BUCKETS] = {};      ///< values per bucket
+    uint32_t count = 0;                 ///< number of values
+    uint64_t sum = 0;                   ///< sum of the values
+    unsigned long max = 0;              ///< largest value
+};
+
+#endif // LATENCYHISTOGRAM_H__
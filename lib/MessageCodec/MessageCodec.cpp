@@ -0,0 +1,256 @@
+/**
+ * @file MessageCodec.cpp
+ * @brief Binary CBOR encoding of the messages exchanged between the communication hub and the boxes
+ *
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#include "MessageCodec.h"
+
+#include <string.h>
+
+#define CBOR_UNSIGNED 0x00                  ///< major type of unsigned integers
+#define CBOR_NEGATIVE 0x20                  ///< major type of negative integers
+#define CBOR_TEXT 0x60                      ///< major type of text strings
+#define CBOR_ARRAY 0x80                     ///< major type of arrays
+#define CBOR_FALSE 0xF4                     ///< simple value false
+#define CBOR_TRUE 0xF5                      ///< simple value true
+
+static const uint8_t selfDescribeTag[] = {0xD9, 0xD9, 0xF7};   ///< tag 55799, marks a CBOR payload
+
+/**
+ * @brief Sink which only counts the bytes
+ *
+ */
+class CountingSink
+{
+    public:
+
+    size_t write(const uint8_t *data, size_t length)
+    {
+        (void)data;
+        return length;
+    }
+};
+
+/**
+ * @brief Reads CBOR items from a payload, every read checks the bounds and the type
+ *
+ */
+class CborReader
+{
+    public:
+
+    CborReader(const uint8_t *buffer, size_t length) : pos(buffer), end(buffer + length) {}
+
+    bool head(uint8_t major, uint64_t &value)
+    {
+        if (pos == end || (*pos & 0xE0) != major)
+        {
+            return false;
+        }
+        uint8_t info = *pos++ & 0x1F;
+        if (info < 24)
+        {
+            value = info;
+            return true;
+        }
+        if (info > 27)
+        {
+            return false;                   // indefinite lengths are not used
+        }
+        size_t size = (size_t)1 << (info - 24);
+        if ((size_t)(end - pos) < size)
+        {
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            value = value << 8 | *pos++;
+        }
+        return true;
+    }
+
+    bool integer(long &value)
+    {
+        uint64_t raw;
+        if (head(CBOR_UNSIGNED, raw))
+        {
+            value = (long)raw;
+            return true;
+        }
+        if (head(CBOR_NEGATIVE, raw))
+        {
+            value = -1 - (long)raw;
+            return true;
+        }
+        return false;
+    }
+
+    bool number(unsigned long long &value)
+    {
+        uint64_t raw;
+        if (!head(CBOR_UNSIGNED, raw))
+        {
+            return false;
+        }
+        value = raw;
+        return true;
+    }
+
+    bool text(String &value)
+    {
+        uint64_t length;
+        if (!head(CBOR_TEXT, length) || (uint64_t)(end - pos) < length)
+        {
+            return false;
+        }
+        value = String();
+        value.concat((const char *)pos, (unsigned int)length);
+        pos += length;
+        return true;
+    }
+
+    bool flag(bool &value)
+    {
+        if (pos == end || (*pos != CBOR_TRUE && *pos != CBOR_FALSE))
+        {
+            return false;
+        }
+        value = *pos++ == CBOR_TRUE;
+        return true;
+    }
+
+    bool done() const { return pos == end; }
+
+    private:
+
+    const uint8_t *pos;             ///< next byte to read
+    const uint8_t *const end;       ///< end of the payload
+};
+
+/**
+ * @brief Number of fields after type, id and consignor
+ *
+ * @param type - Message::MessageType
+ * @return size_t - 0 if the type is not encoded
+ */
+static size_t fieldCount(Message::MessageType type)
+{
+    switch (type)
+    {
+    case Message::MessageType::SBAvailable:
+        return 2;
+    case Message::MessageType::SBState:
+        return 1;
+    case Message::MessageType::SBToSOHandshake:
+        return 5;
+    case Message::MessageType::Error:
+    case Message::MessageType::SOBuffer:
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+bool MessageCodec::isBinary(const uint8_t *buffer, size_t length)
+{
+    return length >= sizeof(selfDescribeTag) && !memcmp(buffer, selfDescribeTag, sizeof(selfDescribeTag));
+}
+
+bool MessageCodec::isEncoded(const Message &message)
+{
+    return fieldCount((Message::MessageType)message.msgType) != 0;
+}
+
+size_t MessageCodec::encode(const Message &message, uint8_t *buffer)
+{
+    CborBufferSink sink(buffer, MESSAGE_CODEC_MAX_SIZE);
+    return encode(message, sink);
+}
+
+size_t MessageCodec::encodedLength(const Message &message)
+{
+    CountingSink sink;
+    return encode(message, sink);
+}
+
+std::shared_ptr<Message> MessageCodec::decode(const uint8_t *buffer, size_t length)
+{
+    if (!isBinary(buffer, length))
+    {
+        return nullptr;
+    }
+    CborReader reader(buffer + sizeof(selfDescribeTag), length - sizeof(selfDescribeTag));
+    uint64_t count;
+    unsigned long long type, id, consignor;
+    if (!reader.head(CBOR_ARRAY, count) || !reader.number(type) || !reader.number(id) || !reader.number(consignor))
+    {
+        return nullptr;
+    }
+    if (fieldCount((Message::MessageType)type) == 0 || count != 3 + fieldCount((Message::MessageType)type))
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<Message> message;
+    bool ok = false;
+    switch ((Message::MessageType)type)
+    {
+    case Message::MessageType::SBAvailable:
+    {
+        std::shared_ptr<SBAvailableMessage> available(new SBAvailableMessage());
+        long line = 0;
+        ok = reader.integer(line) && reader.text(available->targetReg);
+        available->line = (int)line;
+        message = available;
+        break;
+    }
+    case Message::MessageType::SBState:
+    {
+        std::shared_ptr<SBStateMessage> state(new SBStateMessage());
+        ok = reader.text(state->state);
+        message = state;
+        break;
+    }
+    case Message::MessageType::SBToSOHandshake:
+    {
+        std::shared_ptr<SBToSOHandshakeMessage> handshake(new SBToSOHandshakeMessage());
+        long line = 0;
+        ok = reader.text(handshake->req) && reader.text(handshake->ack) && reader.text(handshake->cargo) &&
+             reader.text(handshake->targetReg) && reader.integer(line);
+        handshake->line = (int)line;
+        message = handshake;
+        break;
+    }
+    case Message::MessageType::Error:
+    {
+        std::shared_ptr<ErrorMessage> error(new ErrorMessage());
+        ok = reader.flag(error->error) && reader.flag(error->token);
+        message = error;
+        break;
+    }
+    case Message::MessageType::SOBuffer:
+    {
+        std::shared_ptr<BufferMessage> bufferMessage(new BufferMessage());
+        ok = reader.flag(bufferMessage->full) && reader.flag(bufferMessage->cleared);
+        message = bufferMessage;
+        break;
+    }
+    default:
+        break;
+    }
+    if (!ok || !reader.done())
+    {
+        return nullptr;
+    }
+    message->msgType = (int)type;
+    message->msgId = id;
+    message->msgConsignor = (Consignor)consignor;
+    return message;
+}
@@ -0,0 +1,310 @@
+/**
+ * @file MessageCodec.h
+ * @brief Binary CBOR encoding of the messages exchanged between the communication hub and the boxes
+ *
+ * A binary payload starts with the self-describe tag of CBOR (RFC 8949, tag
+ * 55799, bytes D9 D9 F7), which never starts a JSON text. Receivers tell the
+ * formats apart by it, so JSON and CBOR peers share the topics.
+ *
+ * The tag is followed by one array:
+ *
+ * | message                | array                                                  |
+ * |------------------------|--------------------------------------------------------|
+ * | SBAvailableMessage     | [type, id, consignor, line, targetReg]                 |
+ * | SBStateMessage         | [type, id, consignor, state]                           |
+ * | SBToSOHandshakeMessage | [type, id, consignor, req, ack, cargo, targetReg, line] |
+ * | ErrorMessage           | [type, id, consignor, error, token]                    |
+ * | BufferMessage          | [type, id, consignor, full, cleared]                   |
+ *
+ * type is Message::MessageType, numbers are CBOR integers, strings CBOR text
+ * and flags CBOR booleans. Other message types are not encoded, they stay JSON.
+ *
+ * The encoder writes item by item into a sink, e.g. the transmit buffer of the
+ * mqtt client. The length is known before the first byte, encodedLength()
+ * runs the same encoder into a sink which only counts.
+ *
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#ifndef MESSAGECODEC_H__
+#define MESSAGECODEC_H__
+
+#include <Arduino.h>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "MessageTranslation.h"
+
+#define MESSAGE_CODEC_MAX_SIZE 192          ///< size of the largest encoded message, longer strings are not encoded
+
+/**
+ * @brief Binary CBOR encoding of the messages
+ *
+ */
+struct MessageCodec
+{
+    /**
+     * @brief Check whether a payload is CBOR
+     *
+     * @param buffer - payload
+     * @param length - length of the payload
+     * @return true - the payload starts with the self-describe tag
+     * @return false - the payload is JSON
+     */
+    static bool isBinary(const uint8_t *buffer, size_t length);
+
+    /**
+     * @brief Check whether a message type is encoded
+     *
+     * @param message - message
+     * @return true
+     * @return false - the message stays JSON
+     */
+    static bool isEncoded(const Message &message);
+
+    /**
+     * @brief Serialize a message into a buffer
+     *
+     * @param message - message to serialize
+     * @param buffer - MESSAGE_CODEC_MAX_SIZE bytes
+     * @return size_t - length of the payload, 0 if the type is not encoded or the message is too long
+     */
+    static size_t encode(const Message &message, uint8_t *buffer);
+
+    /**
+     * @brief Get the length of the serialized message without serializing it
+     *
+     * @param message - message
+     * @return size_t - length of the payload, 0 if the type is not encoded
+     */
+    static size_t encodedLength(const Message &message);
+
+    /**
+     * @brief Serialize a message item by item into a sink
+     *
+     * @tparam Sink - has size_t write(const uint8_t *data, size_t length), which returns the bytes taken
+     * @param message - message to serialize
+     * @param sink - receives the payload
+     * @return size_t - length of the payload, 0 if the type is not encoded or the sink did not take every byte
+     */
+    template <typename Sink>
+    static size_t encode(const Message &message, Sink &sink);
+
+    /**
+     * @brief Deserialize a message
+     *
+     * @param buffer - payload, starts with the self-describe tag
+     * @param length - length of the payload
+     * @return std::shared_ptr<Message> - nullptr if the payload is malformed or of an unknown type
+     */
+    static std::shared_ptr<Message> decode(const uint8_t *buffer, size_t length);
+};
+
+/**
+ * @brief Writes CBOR items into a sink
+ *
+ * @tparam Sink - see MessageCodec::encode()
+ */
+template <typename Sink>
+class CborWriter
+{
+    //======================PUBLIC===========================================================
+    public:
+
+    static const uint8_t UNSIGNED = 0x00;   ///< major type of unsigned integers
+    static const uint8_t NEGATIVE = 0x20;   ///< major type of negative integers
+    static const uint8_t TEXT = 0x60;       ///< major type of text strings
+    static const uint8_t ARRAY = 0x80;      ///< major type of arrays
+
+    explicit CborWriter(Sink &sink) : sink(sink) {}
+
+    /**
+     * @brief Write the head of an item, the argument in the shortest form
+     *
+     * @param major - major type
+     * @param value - value or length
+     */
+    void head(uint8_t major, uint64_t value)
+    {
+        uint8_t bytes[9];
+        uint8_t size = value < 24 ? 0 : value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : value <= 0xFFFFFFFF ? 4 : 8;
+        bytes[0] = major | (size == 0 ? (uint8_t)value : size == 1 ? 24 : size == 2 ? 25 : size == 4 ? 26 : 27);
+        for (uint8_t i = 0; i < size; i++)
+        {
+            bytes[size - i] = (uint8_t)(value >> (8 * i));     // network byte order
+        }
+        raw(bytes, 1 + size);
+    }
+
+    /**
+     * @brief Write the self-describe tag which marks a CBOR payload
+     *
+     */
+    void selfDescribe()
+    {
+        static const uint8_t tag[] = {0xD9, 0xD9, 0xF7};   // tag 55799
+        raw(tag, sizeof(tag));
+    }
+
+    void integer(long value)
+    {
+        if (value < 0)
+        {
+            head(NEGATIVE, (uint64_t)(-1 - value));
+        }
+        else
+        {
+            head(UNSIGNED, (uint64_t)value);
+        }
+    }
+
+    void text(const String &value)
+    {
+        head(TEXT, value.length());
+        raw((const uint8_t *)value.c_str(), value.length());
+    }
+
+    void flag(bool value)
+    {
+        uint8_t simple = value ? 0xF5 : 0xF4;
+        raw(&simple, 1);
+    }
+
+    void raw(const uint8_t *data, size_t size)
+    {
+        if (ok && size > 0)
+        {
+            ok = sink.write(data, size) == size;
+            written += size;
+        }
+    }
+
+    /**
+     * @brief Get the number of written bytes
+     *
+     * @return size_t - 0 if the sink did not take every byte
+     */
+    size_t length() const { return ok ? written : 0; }
+
+    //======================PRIVATE==========================================================
+    private:
+
+    Sink &sink;                     ///< receives the payload
+    size_t written = 0;             ///< bytes written so far
+    bool ok = true;                 ///< the sink took every byte
+};
+
+/**
+ * @brief Sink into a buffer, takes nothing of a write which does not fit
+ *
+ */
+class CborBufferSink
+{
+    //======================PUBLIC===========================================================
+    public:
+
+    /**
+     * @brief Construct a new Cbor Buffer Sink object
+     *
+     * @param buffer - receives the payload
+     * @param size - size of the buffer
+     */
+    CborBufferSink(uint8_t *buffer, size_t size) : pos(buffer), end(buffer + size) {}
+
+    size_t write(const uint8_t *data, size_t length)
+    {
+        if ((size_t)(end - pos) < length)
+        {
+            return 0;
+        }
+        memcpy(pos, data, length);
+        pos += length;
+        return length;
+    }
+
+    //======================PRIVATE==========================================================
+    private:
+
+    uint8_t *pos;                   ///< next byte to write
+    uint8_t *const end;             ///< end of the buffer
+};
+
+template <typename Sink>
+size_t MessageCodec::encode(const Message &message, Sink &sink)
+{
+    if (!isEncoded(message))
+    {
+        return 0;
+    }
+
+    CborWriter<Sink> writer(sink);
+    writer.selfDescribe();
+    switch ((Message::MessageType)message.msgType)
+    {
+    case Message::MessageType::SBAvailable:
+    {
+        const SBAvailableMessage &available = static_cast<const SBAvailableMessage &>(message);
+        writer.head(CborWriter<Sink>::ARRAY, 5);
+        writer.head(CborWriter<Sink>::UNSIGNED, (uint64_t)message.msgType);
+        writer.head(CborWriter<Sink>::UNSIGNED, message.msgId);
+        writer.head(CborWriter<Sink>::UNSIGNED, (uint64_t)message.msgConsignor);
+        writer.integer(available.line);
+        writer.text(available.targetReg);
+        break;
+    }
+    case Message::MessageType::SBState:
+        writer.head(CborWriter<Sink>::ARRAY, 4);
+        writer.head(CborWriter<Sink>::UNSIGNED, (uint64_t)message.msgType);
+        writer.head(CborWriter<Sink>::UNSIGNED, message.msgId);
+        writer.head(CborWriter<Sink>::UNSIGNED, (uint64_t)message.msgConsignor);
+        writer.text(static_cast<const SBStateMessage &>(message).state);
+        break;
+    case Message::MessageType::SBToSOHandshake:
+    {
+        const SBToSOHandshakeMessage &handshake = static_cast<const SBToSOHandshakeMessage &>(message);
+        writer.head(CborWriter<Sink>::ARRAY, 8);
+        writer.head(CborWriter<Sink>::UNSIGNED, (uint64_t)message.msgType);
+        writer.head(CborWriter<Sink>::UNSIGNED, message.msgId);
+        writer.head(CborWriter<Sink>::UNSIGNED, (uint64_t)message.msgConsignor);
+        writer.text(handshake.req);
+        writer.text(handshake.ack);
+        writer.text(handshake.cargo);
+        writer.text(handshake.targetReg);
+        writer.integer(handshake.line);
+        break;
+    }
+    case Message::MessageType::Error:
+    {
+        const ErrorMessage &error = static_cast<const ErrorMessage &>(message);
+        writer.head(CborWriter<Sink>::ARRAY, 5);
+        writer.head(CborWriter<Sink>::UNSIGNED, (uint64_t)message.msgType);
+        writer.head(CborWriter<Sink>::UNSIGNED, message.msgId);
+        writer.head(CborWriter<Sink>::UNSIGNED, (uint64_t)message.msgConsignor);
+        writer.flag(error.error);
+        writer.flag(error.token);
+        break;
+    }
+    case Message::MessageType::SOBuffer:
+    {
+        const BufferMessage &buffer = static_cast<const BufferMessage &>(message);
+        writer.head(CborWriter<Sink>::ARRAY, 5);
+        writer.head(CborWriter<Sink>::UNSIGNED, (uint64_t)message.msgType);
+        writer.head(CborWriter<Sink>::UNSIGNED, message.msgId);
+        writer.head(CborWriter<Sink>::UNSIGNED, (uint64_t)message.msgConsignor);
+        writer.flag(buffer.full);
+        writer.flag(buffer.cleared);
+        break;
+    }
+    default:
+        break;
+    }
+    return writer.length();
+}
+
+#endif // MESSAGECODEC_H__
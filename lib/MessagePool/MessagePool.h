@@ -0,0 +1,87 @@
+/**
+ * @file MessagePool.h
+ * @brief Pool of reusable message structs for outgoing messages
+ * 
+ * The slots are created once with the pool. acquire() hands out a slot which
+ * nobody else holds, reset to a default constructed message, so publishing
+ * does not allocate a new message struct every time. The reset copies a
+ * blank message the pool keeps: the String members are assigned in place and
+ * keep their capacity, where assigning a temporary T() would build new
+ * Strings on every acquire().
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef MESSAGEPOOL_H__
+#define MESSAGEPOOL_H__
+
+#include <stddef.h>
+#include <memory>
+
+/**
+ * @brief Pool of reusable message structs of one type
+ * 
+ * @tparam T - message struct, default constructible and copy assignable
+ * @tparam SLOTS - number of messages which can be held at the same time
+ */
+template <typename T, size_t SLOTS = 1>
+class MessagePool
+{
+    static_assert(SLOTS > 0, "MessagePool needs a slot");
+
+    //======================PUBLIC===========================================================
+    public:
+
+    /**
+     * @brief Construct a new Message Pool object and allocate all slots
+     * 
+     */
+    MessagePool()
+    {
+        for (size_t i = 0; i < SLOTS; i++)
+        {
+            slots[i] = std::make_shared<T>();
+        }
+    }
+
+    /**
+     * @brief Get a message reset to its default values
+     * 
+     * - a slot is free again as soon as the caller drops its pointer
+     * - if all slots are held, a new message is allocated and counted as miss
+     * 
+     * @return std::shared_ptr<T> - message to fill with setMessage()
+     */
+    std::shared_ptr<T> acquire()
+    {
+        for (size_t i = 0; i < SLOTS; i++)
+        {
+            if (slots[i].use_count() == 1)
+            {
+                *slots[i] = blank;
+                return slots[i];
+            }
+        }
+        misses++;
+        return std::make_shared<T>();
+    }
+
+    /**
+     * @brief Get the number of acquire() calls which had to allocate
+     * 
+     * @return unsigned long 
+     */
+    unsigned long getMisses() const { return misses; }
+
+    //======================PRIVATE==========================================================
+    private:
+    std::shared_ptr<T> slots[SLOTS];    ///< messages owned by the pool
+    const T blank = T();                ///< default constructed message the slots are reset to
+    unsigned long misses = 0;           ///< number of allocations because all slots were held
+};
+
+#endif // MESSAGEPOOL_H__
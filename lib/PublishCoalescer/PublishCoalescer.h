@@ -0,0 +1,182 @@
+/**
+ * @file PublishCoalescer.h
+ * @brief Latest-value-wins stage for outgoing messages of frequently reported values
+ *
+ * Every slot stands for one topic and holds the last published value and the
+ * latest offered one. A value equal to the published one is dropped. The
+ * first changed value opens a window; values offered within it replace the
+ * pending one, so a burst leaves one message with the latest value when the
+ * window is due.
+ *
+ * The slots hold values, not serialized messages, so a dropped value costs
+ * no message id and no serialization.
+ *
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#ifndef PUBLISHCOALESCER_H__
+#define PUBLISHCOALESCER_H__
+
+#include <stddef.h>
+
+/**
+ * @brief Per-topic slots of the latest value to publish
+ *
+ * @tparam SLOTS - number of coalesced topics
+ */
+template <size_t SLOTS>
+class PublishCoalescer
+{
+    //======================PUBLIC===========================================================
+    public:
+
+    /**
+     * @brief Construct a new Publish Coalescer object
+     *
+     * @param window - time in ms a changed value is held back, 0 publishes it on the next flush
+     */
+    explicit PublishCoalescer(unsigned long window) : window(window) {}
+
+    /**
+     * @brief Offer a new value of a topic
+     *
+     * @param slot - slot of the topic
+     * @param value - reported value
+     * @param now - time in ms
+     * @return true - the value waits in the slot
+     * @return false - the value was published already, nothing to send
+     */
+    bool offer(size_t slot, long value, unsigned long now)
+    {
+        if (slot >= SLOTS)
+        {
+            return false;
+        }
+        Slot &entry = slots[slot];
+        if (entry.sent && entry.published == value)
+        {
+            // a burst which returns to the published value sends nothing
+            dropped += entry.pending ? 2 : 1;
+            entry.pending = false;
+            return false;
+        }
+        if (entry.pending)
+        {
+            dropped++;                          // the latest value wins
+        }
+        else
+        {
+            entry.pending = true;
+            entry.since = now;
+        }
+        entry.latest = value;
+        return true;
+    }
+
+    /**
+     * @brief Check whether a topic has a value to publish
+     *
+     * @param slot - slot of the topic
+     * @return true
+     * @return false
+     */
+    bool isPending(size_t slot) const { return slot < SLOTS && slots[slot].pending; }
+
+    /**
+     * @brief Check whether the window of a pending value is over
+     *
+     * @param slot - slot of the topic
+     * @param now - time in ms
+     * @return true
+     * @return false
+     */
+    bool isDue(size_t slot, unsigned long now) const
+    {
+        return isPending(slot) && now - slots[slot].since >= window;
+    }
+
+    /**
+     * @brief Get the time until the next pending value is due
+     *
+     * @param now - time in ms
+     * @return unsigned long - 0 if a value is due, NO_VALUE if nothing is pending
+     */
+    unsigned long timeToDue(unsigned long now) const
+    {
+        unsigned long next = NO_VALUE;
+        for (size_t i = 0; i < SLOTS; i++)
+        {
+            if (slots[i].pending)
+            {
+                unsigned long remaining = isDue(i, now) ? 0 : window - (now - slots[i].since);
+                next = remaining < next ? remaining : next;
+            }
+        }
+        return next;
+    }
+
+    /**
+     * @brief Take the pending value of a topic to publish it
+     *
+     * @param slot - slot of the topic, must be pending
+     * @return long - latest value
+     */
+    long take(size_t slot)
+    {
+        Slot &entry = slots[slot];
+        entry.pending = false;
+        entry.sent = true;
+        entry.published = entry.latest;
+        return entry.latest;
+    }
+
+    /**
+     * @brief Forget the published value, call when another message went to the topic
+     *
+     * - the next offered value is published even if it did not change
+     *
+     * @param slot - slot of the topic
+     */
+    void forget(size_t slot)
+    {
+        if (slot < SLOTS)
+        {
+            slots[slot].sent = false;
+        }
+    }
+
+    /**
+     * @brief Get the number of offered values which were not published
+     *
+     * @return unsigned long
+     */
+    unsigned long getDropped() const { return dropped; }
+
+    static const unsigned long NO_VALUE = (unsigned long)-1;   ///< timeToDue() without pending values
+
+    //======================PRIVATE==========================================================
+    private:
+
+    /**
+     * @brief Published and pending value of a topic
+     *
+     */
+    struct Slot
+    {
+        long published = 0;             ///< last published value
+        long latest = 0;                ///< latest offered value
+        unsigned long since = 0;        ///< time the pending value was first offered
+        bool sent = false;              ///< published is valid
+        bool pending = false;           ///< latest waits to be published
+    };
+
+    const unsigned long window;         ///< time in ms a changed value is held back
+    Slot slots[SLOTS];                  ///< slot of every topic
+    unsigned long dropped = 0;          ///< offered values which were not published
+};
+
+#endif // PUBLISHCOALESCER_H__
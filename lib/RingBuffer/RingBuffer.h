@@ -0,0 +1,138 @@
+/**
+ * @file RingBuffer.h
+ * @brief Fixed capacity ring buffer which stores its elements by value
+ * 
+ * All elements live in the buffer itself, so pushing and popping never
+ * allocates. The interface follows the part of std::deque the message buffers
+ * used: the newest element is pushed to the front, at(0) is the front.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef RINGBUFFER_H__
+#define RINGBUFFER_H__
+
+#include <stddef.h>
+
+/**
+ * @brief Enum class holds what a full ring buffer does with a pushed element
+ * 
+ */
+enum class OverflowPolicy
+{
+    DropOldest,         ///< overwrite the oldest element (back)
+    DropNewest          ///< reject the pushed element
+};
+
+/**
+ * @brief Fixed capacity ring buffer
+ * 
+ * @tparam T - element type, default constructible and copy assignable
+ * @tparam CAPACITY - maximum number of elements
+ * @tparam POLICY - behaviour of push_front() on a full buffer
+ */
+template <typename T, size_t CAPACITY, OverflowPolicy POLICY = OverflowPolicy::DropOldest>
+class RingBuffer
+{
+    static_assert(CAPACITY > 0, "RingBuffer needs a capacity");
+
+    //======================PUBLIC===========================================================
+    public:
+
+    /**
+     * @brief Push an element to the front
+     * 
+     * @param element - copied into the buffer
+     * @return true - element stored
+     * @return false - buffer full and policy DropNewest, element dropped
+     */
+    bool push_front(const T &element)
+    {
+        if (count == CAPACITY)
+        {
+            dropped++;
+            if (POLICY == OverflowPolicy::DropNewest)
+            {
+                return false;
+            }
+            count--;    // overwrite the oldest element
+        }
+        head = head == 0 ? CAPACITY - 1 : head - 1;
+        items[head] = element;
+        count++;
+        return true;
+    }
+
+    /**
+     * @brief Remove the front element, the buffer must not be empty
+     * 
+     */
+    void pop_front()
+    {
+        head = head + 1 == CAPACITY ? 0 : head + 1;
+        count--;
+    }
+
+    /**
+     * @brief Remove the back element, the buffer must not be empty
+     * 
+     */
+    void pop_back()
+    {
+        count--;
+    }
+
+    /**
+     * @brief Access the front (newest) element, the buffer must not be empty
+     * 
+     * @return T& 
+     */
+    T &front() { return items[head]; }
+    const T &front() const { return items[head]; }
+
+    /**
+     * @brief Access the back (oldest) element, the buffer must not be empty
+     * 
+     * @return T& 
+     */
+    T &back() { return at(count - 1); }
+    const T &back() const { return at(count - 1); }
+
+    /**
+     * @brief Access an element counted from the front, index must be below size()
+     * 
+     * @param index 
+     * @return T& 
+     */
+    T &at(size_t index) { return items[(head + index) % CAPACITY]; }
+    const T &at(size_t index) const { return items[(head + index) % CAPACITY]; }
+
+    /**
+     * @brief Remove all elements
+     * 
+     */
+    void clear()
+    {
+        head = 0;
+        count = 0;
+    }
+
+    size_t size() const { return count; }                   ///< number of elements
+    bool empty() const { return count == 0; }               ///< no elements
+    bool full() const { return count == CAPACITY; }         ///< no free space
+    static constexpr size_t capacity() { return CAPACITY; } ///< maximum number of elements
+    unsigned long getDropped() const { return dropped; }    ///< number of elements lost by overflow
+
+    //======================PRIVATE==========================================================
+    private:
+    T items[CAPACITY];              ///< storage of the elements
+    size_t head = 0;                ///< index of the front element
+    size_t count = 0;               ///< number of elements
+    unsigned long dropped = 0;      ///< number of elements lost by overflow
+};
+
+#endif // RINGBUFFER_H__
@@ -0,0 +1,131 @@
+/**
+ * @file SpscQueue.h
+ * @brief Lock-free queue for exactly one producer and one consumer thread
+ * 
+ * The producer only writes tail, the consumer only writes head, both are
+ * atomics with acquire / release ordering. The elements live in the queue,
+ * a slot is written in place by the producer and read in place by the
+ * consumer, so elements with own storage (String) keep it for the next use.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef SPSCQUEUE_H__
+#define SPSCQUEUE_H__
+
+#include <stddef.h>
+#include <atomic>
+
+/**
+ * @brief Single producer single consumer queue
+ * 
+ * @tparam T - element type, default constructible
+ * @tparam CAPACITY - maximum number of elements
+ */
+template <typename T, size_t CAPACITY>
+class SpscQueue
+{
+    static_assert(CAPACITY > 0, "SpscQueue needs a capacity");
+
+    //======================PUBLIC===========================================================
+    public:
+
+    /**
+     * @brief Producer: get the free slot to fill
+     * 
+     * @return T* - slot, nullptr if the queue is full
+     */
+    T *beginPush()
+    {
+        size_t current = tail.load(std::memory_order_relaxed);
+        if (next(current) == head.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        return &items[current];
+    }
+
+    /**
+     * @brief Producer: hand the slot filled after beginPush() to the consumer
+     * 
+     */
+    void endPush()
+    {
+        tail.store(next(tail.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    /**
+     * @brief Producer: copy an element into the queue
+     * 
+     * @param element 
+     * @return true - element queued
+     * @return false - queue full, element dropped
+     */
+    bool push(const T &element)
+    {
+        T *slot = beginPush();
+        if (!slot)
+        {
+            return false;
+        }
+        *slot = element;
+        endPush();
+        return true;
+    }
+
+    /**
+     * @brief Consumer: get the oldest element
+     * 
+     * @return T* - element, nullptr if the queue is empty
+     */
+    T *front()
+    {
+        size_t current = head.load(std::memory_order_relaxed);
+        if (current == tail.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        return &items[current];
+    }
+
+    /**
+     * @brief Consumer: release the element returned by front() to the producer
+     * 
+     */
+    void pop()
+    {
+        head.store(next(head.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    /**
+     * @brief Check whether the queue is empty, exact only for the consumer
+     * 
+     * @return true 
+     * @return false 
+     */
+    bool empty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return CAPACITY; }    ///< maximum number of elements
+
+    //======================PRIVATE==========================================================
+    private:
+
+    /**
+     * @brief Index of the slot after a slot
+     * 
+     */
+    static size_t next(size_t index) { return index + 1 == CAPACITY + 1 ? 0 : index + 1; }
+
+    T items[CAPACITY + 1];                  ///< storage, one slot stays free to tell full from empty
+    std::atomic<size_t> head{0};            ///< next slot to read, written by the consumer
+    std::atomic<size_t> tail{0};            ///< next slot to write, written by the producer
+};
+
+#endif // SPSCQUEUE_H__
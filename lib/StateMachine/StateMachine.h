@@ -0,0 +1,210 @@
+/**
+ * @file StateMachine.h
+ * @brief Table driven finite state machine with entry, do and exit actions
+ * 
+ * The transitions are a dense table indexed by (State, Event), so dispatching
+ * an event is one array lookup. Every entry carries its own key, which lets
+ * isTransitionTableComplete() detect a missing or misplaced pair at compile time.
+ * 
+ * States and events have to be enum classes with consecutive values starting at 0.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef STATEMACHINE_H__
+#define STATEMACHINE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Enum class holds the kinds of transitions
+ * 
+ */
+enum class TransitionKind : uint8_t
+{
+    Ignore,         ///< event has no effect in this state
+    Internal,       ///< stay in the state without exit and entry action, the event becomes the current event
+    External,       ///< exit the state and enter the next state
+    History         ///< exit the state and re-enter the previous state with its previous event
+};
+
+/**
+ * @brief One entry of the transition table
+ * 
+ */
+template <typename State, typename Event>
+struct Transition
+{
+    State state;                ///< key: state the event occurs in
+    Event event;                ///< key: occurred event
+    TransitionKind kind;        ///< kind of the transition
+    State nextState;            ///< target state of an external transition
+};
+
+/**
+ * @brief Actions of one state
+ * 
+ */
+template <typename Owner, typename State, typename Event>
+struct StateActions
+{
+    State state;                        ///< key: state of the actions
+    void (Owner::*entryAction)();       ///< called when entering the state
+    Event (Owner::*doAction)();         ///< called every loop, generates the next event
+    void (Owner::*exitAction)();        ///< called when leaving the state
+};
+
+/**
+ * @brief Check at compile time that every (State, Event) pair has its entry at its place
+ * 
+ * @return true - table is complete
+ * @return false - an entry is missing or misplaced
+ */
+template <typename State, typename Event, size_t STATES, size_t EVENTS>
+constexpr bool isTransitionTableComplete(const Transition<State, Event> (&table)[STATES][EVENTS], size_t state = 0, size_t event = 0)
+{
+    return state == STATES ? true
+         : event == EVENTS ? isTransitionTableComplete(table, state + 1, 0)
+         : (size_t)table[state][event].state == state && (size_t)table[state][event].event == event &&
+           isTransitionTableComplete(table, state, event + 1);
+}
+
+/**
+ * @brief Check at compile time that every state has its actions at its place
+ * 
+ * @return true - table is complete
+ * @return false - actions are missing or misplaced
+ */
+template <typename Owner, typename State, typename Event, size_t STATES>
+constexpr bool isStateTableComplete(const StateActions<Owner, State, Event> (&table)[STATES], size_t state = 0)
+{
+    return state == STATES ? true
+         : (size_t)table[state].state == state && table[state].entryAction != nullptr &&
+           table[state].doAction != nullptr && table[state].exitAction != nullptr &&
+           isStateTableComplete(table, state + 1);
+}
+
+/**
+ * @brief Runs a state machine described by a transition table and a state table
+ * 
+ * @tparam Owner - class which implements the actions
+ * @tparam State - enum class of the states
+ * @tparam Event - enum class of the events
+ * @tparam STATES - number of states
+ * @tparam EVENTS - number of events
+ */
+template <typename Owner, typename State, typename Event, size_t STATES, size_t EVENTS>
+class StateMachine
+{
+    //======================PUBLIC===========================================================
+    public:
+
+    typedef Transition<State, Event> TransitionTable[STATES][EVENTS];      ///< type of the transition table
+    typedef StateActions<Owner, State, Event> StateTable[STATES];          ///< type of the state table
+
+    /**
+     * @brief Construct a new State Machine object
+     * 
+     * - the entry action of the initial state is not called
+     * 
+     * @param owner - object the actions are called on
+     * @param transitions - transition table
+     * @param states - state table
+     * @param initialState - first state
+     * @param initialEvent - current event of the first state
+     */
+    StateMachine(Owner *owner, const TransitionTable &transitions, const StateTable &states, State initialState, Event initialEvent)
+        : owner(owner), transitions(transitions), states(states),
+          currentState(initialState), currentEvent(initialEvent), previousState(initialState), previousEvent(initialEvent)
+    {
+    }
+
+    /**
+     * @brief Calls the do-action of the current state
+     * 
+     * @return Event - generated Event
+     */
+    Event doAction()
+    {
+        return (owner->*states[(size_t)currentState].doAction)();
+    }
+
+    /**
+     * @brief Changes the state based on the event
+     * 
+     * @param event - Event
+     */
+    void process(Event event)
+    {
+        const Transition<State, Event> &transition = transitions[(size_t)currentState][(size_t)event];
+        switch (transition.kind)
+        {
+        case TransitionKind::Ignore:
+            break;
+        case TransitionKind::Internal:
+            currentEvent = event;
+            break;
+        case TransitionKind::External:
+            enter(transition.nextState, event);
+            break;
+        case TransitionKind::History:
+            enter(previousState, previousEvent);
+            break;
+        }
+    }
+
+    /**
+     * @brief Get the current state
+     * 
+     * @return State
+     */
+    State getState() const { return currentState; }
+
+    /**
+     * @brief Get the event which entered the current state or the last internal event
+     * 
+     * @return Event
+     */
+    Event getEvent() const { return currentEvent; }
+
+    /**
+     * @brief Get the state which was left to enter the current state
+     * 
+     * @return State
+     */
+    State getPreviousState() const { return previousState; }
+
+    //======================PRIVATE==========================================================
+    private:
+
+    /**
+     * @brief Exit the current state and enter the next state
+     * 
+     * @param nextState - State
+     * @param event - Event which becomes the current event
+     */
+    void enter(State nextState, Event event)
+    {
+        (owner->*states[(size_t)currentState].exitAction)();
+        previousState = currentState;
+        previousEvent = currentEvent;
+        currentState = nextState;
+        currentEvent = event;
+        (owner->*states[(size_t)currentState].entryAction)();
+    }
+
+    Owner *owner;                           ///< object the actions are called on
+    const TransitionTable &transitions;     ///< transition table
+    const StateTable &states;               ///< state table
+    State currentState;                     ///< holds current state
+    Event currentEvent;                     ///< holds event which entered the current state
+    State previousState;                    ///< holds state which was left to enter the current state
+    Event previousEvent;                    ///< holds current event of the previous state
+};
+
+#endif // STATEMACHINE_H__
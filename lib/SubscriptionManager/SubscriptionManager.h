@@ -0,0 +1,199 @@
+/**
+ * @file SubscriptionManager.h
+ * @brief Idempotent, reference counted subscriptions over the mqtt client
+ * 
+ * Several owners (the sortic roboters of the hub) share one mqtt client. Every
+ * owner keeps its topics as a set over the handles of the topic table, the
+ * manager counts the owners of every topic. A SUBSCRIBE is only sent to the
+ * broker for the first owner of a topic, an UNSUBSCRIBE only for the last one,
+ * all other requests are counted as saved round trips.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef SUBSCRIPTIONMANAGER_H__
+#define SUBSCRIPTIONMANAGER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <bitset>
+
+#include "TopicTable.h"
+
+/**
+ * @brief Subscription manager
+ * 
+ * - topics which are not interned (scratch slot of the topic table) are passed
+ *   to the client on every call, they are not tracked
+ * 
+ * @tparam Client - mqtt client with subscribe(String) and unsubscribe(String)
+ * @tparam Topics - topic table with CAPACITY, name(TopicHandle) and isInterned(TopicHandle)
+ */
+template <typename Client, typename Topics>
+class SubscriptionManager
+{
+    //======================PUBLIC===========================================================
+    public:
+
+    typedef std::bitset<Topics::CAPACITY> TopicSet;     ///< set of topic handles of one owner, bit n is handle n
+
+    /**
+     * @brief Construct a new Subscription Manager object
+     * 
+     * @param client - mqtt client
+     * @param topics - topic table the handles belong to
+     */
+    SubscriptionManager(Client &client, const Topics &topics) : client(client), topics(topics)
+    {
+        for (size_t i = 0; i < Topics::CAPACITY; i++)
+        {
+            owners[i] = 0;
+        }
+    }
+
+    /**
+     * @brief Add a topic to the set of an owner
+     * 
+     * @param owner - TopicSet of the owner
+     * @param handle - TopicHandle
+     */
+    void subscribe(TopicSet &owner, TopicHandle handle)
+    {
+        if (!isTracked(handle))
+        {
+            sent++;
+            client.subscribe(topics.name(handle));
+        }
+        else if (owner.test(handle) || owners[handle]++ > 0)
+        {
+            owner.set(handle);
+            saved++;
+        }
+        else
+        {
+            owner.set(handle);
+            sent++;
+            client.subscribe(topics.name(handle));
+        }
+    }
+
+    /**
+     * @brief Remove a topic from the set of an owner
+     * 
+     * @param owner - TopicSet of the owner
+     * @param handle - TopicHandle
+     */
+    void unsubscribe(TopicSet &owner, TopicHandle handle)
+    {
+        if (!isTracked(handle))
+        {
+            sent++;
+            client.unsubscribe(topics.name(handle));
+        }
+        else if (!owner.test(handle) || --owners[handle] > 0)
+        {
+            owner.reset(handle);
+            saved++;
+        }
+        else
+        {
+            owner.reset(handle);
+            sent++;
+            client.unsubscribe(topics.name(handle));
+        }
+    }
+
+    /**
+     * @brief Replace the set of an owner, only the difference is requested
+     * 
+     * @param owner - TopicSet of the owner
+     * @param set - new TopicSet of the owner
+     */
+    void apply(TopicSet &owner, const TopicSet &set)
+    {
+        TopicSet changed = owner ^ set;
+        size_t remaining = changed.count();
+        for (TopicHandle handle = 0; remaining > 0; handle++)
+        {
+            if (changed.test(handle))
+            {
+                remaining--;
+                if (set.test(handle))
+                {
+                    subscribe(owner, handle);
+                }
+                else
+                {
+                    unsubscribe(owner, handle);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Send all topics with an owner again, call after the client reconnected
+     * 
+     * - a new broker session starts without subscriptions
+     */
+    void reapply()
+    {
+        for (TopicHandle handle = 0; handle < Topics::CAPACITY; handle++)
+        {
+            if (owners[handle] > 0)
+            {
+                sent++;
+                client.subscribe(topics.name(handle));
+            }
+        }
+    }
+
+    /**
+     * @brief Send a subscribed topic again, the broker delivers its retained messages once more
+     * 
+     * @param handle - TopicHandle
+     */
+    void refresh(TopicHandle handle)
+    {
+        if (isSubscribed(handle))
+        {
+            sent++;
+            client.subscribe(topics.name(handle));
+        }
+    }
+
+    /**
+     * @brief Check whether a topic is subscribed at the broker
+     * 
+     * @param handle - TopicHandle
+     * @return true
+     * @return false
+     */
+    bool isSubscribed(TopicHandle handle) const { return isTracked(handle) && owners[handle] > 0; }
+
+    unsigned long getSent() const { return sent; }          ///< number of requests sent to the broker
+    unsigned long getSaved() const { return saved; }        ///< number of requests not sent because nothing changed
+
+    //======================PRIVATE==========================================================
+    private:
+
+    /**
+     * @brief Check whether a topic can be counted
+     * 
+     * @param handle - TopicHandle
+     * @return true
+     * @return false
+     */
+    bool isTracked(TopicHandle handle) const { return topics.isInterned(handle); }
+
+    Client &client;                         ///< mqtt client
+    const Topics &topics;                   ///< topic table the handles belong to
+    uint8_t owners[Topics::CAPACITY];       ///< number of owners of every topic
+    unsigned long sent = 0;                 ///< number of requests sent to the broker
+    unsigned long saved = 0;                ///< number of requests not sent because nothing changed
+};
+
+#endif // SUBSCRIPTIONMANAGER_H__
@@ -0,0 +1,263 @@
+/**
+ * @file TimerWheel.h
+ * @brief Hashed timer wheel for cooperative periodic and one-shot tasks
+ *
+ * Every task has a deadline in milliseconds and sits in the slot
+ * deadline % SLOTS of the wheel. run() only visits the slots between the last
+ * and the current call, so its cost depends on the elapsed time and the due
+ * tasks, not on the number of registered tasks.
+ *
+ * All times are millis() values, comparisons are done on the difference so
+ * the wrap-around of millis() after 49 days is handled.
+ *
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#ifndef TIMERWHEEL_H__
+#define TIMERWHEEL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Hashed timer wheel
+ *
+ * @tparam Owner - class which implements the task actions
+ * @tparam TASKS - number of tasks, a task is identified by its index
+ * @tparam SLOTS - number of slots of the wheel, one slot per millisecond
+ */
+template <typename Owner, size_t TASKS, size_t SLOTS = 64>
+class TimerWheel
+{
+    static_assert(TASKS > 0 && TASKS < 255, "task index is 8 bit");
+    static_assert(SLOTS > 0, "TimerWheel needs a slot");
+
+    //======================PUBLIC===========================================================
+    public:
+
+    typedef void (Owner::*Action)();                        ///< action of a task
+    static const unsigned long NO_DEADLINE = (unsigned long)-1;   ///< no task is active
+
+    /**
+     * @brief Construct a new Timer Wheel object
+     *
+     * @param owner - object the actions are called on
+     */
+    explicit TimerWheel(Owner *owner) : owner(owner)
+    {
+        for (size_t i = 0; i < SLOTS; i++)
+        {
+            slots[i] = NONE;
+        }
+    }
+
+    /**
+     * @brief Start or restart a task
+     *
+     * @param task - index of the task
+     * @param now - current time
+     * @param delay - time until the first run, 0 runs it on the next run()
+     * @param period - time between the runs, 0 runs it once
+     * @param action - called when the task is due, may be nullptr for a pure timeout
+     */
+    void start(size_t task, unsigned long now, unsigned long delay, unsigned long period, Action action)
+    {
+        stop(task);
+        Timer &timer = timers[task];
+        timer.deadline = now + delay;
+        timer.period = period;
+        timer.action = action;
+        timer.active = true;
+        link(task);
+    }
+
+    /**
+     * @brief Stop a task, nothing happens if it is not active
+     *
+     * @param task - index of the task
+     */
+    void stop(size_t task)
+    {
+        if (timers[task].active)
+        {
+            unlink(task);
+            timers[task].active = false;
+        }
+    }
+
+    /**
+     * @brief Check whether a task is waiting for its deadline
+     *
+     * - a one-shot task is not active anymore after it ran
+     *
+     * @param task - index of the task
+     * @return true
+     * @return false
+     */
+    bool isActive(size_t task) const { return timers[task].active; }
+
+    /**
+     * @brief Run all due tasks
+     *
+     * @param now - current time
+     * @return unsigned long - time until the next deadline, NO_DEADLINE if no task is active
+     */
+    unsigned long run(unsigned long now)
+    {
+        // collect first, the actions may start and stop tasks
+        uint8_t due[TASKS];
+        size_t dueCount = 0;
+        unsigned long elapsed = now - lastRun;
+        size_t steps = elapsed >= SLOTS ? SLOTS : (size_t)elapsed + 1;
+        for (size_t step = 0; step < steps; step++)
+        {
+            for (uint8_t task = slots[(lastRun + step) % SLOTS]; task != NONE; task = timers[task].next)
+            {
+                if (isDue(timers[task], now))
+                {
+                    due[dueCount++] = task;
+                }
+            }
+        }
+        lastRun = now;
+
+        for (size_t i = 0; i < dueCount; i++)
+        {
+            size_t task = due[i];
+            Timer &timer = timers[task];
+            if (!timer.active || !isDue(timer, now))
+            {
+                continue;   // stopped or restarted by an earlier action
+            }
+            unlink(task);
+            if (timer.period > 0)
+            {
+                // keep the rhythm, but skip runs which were missed completely
+                timer.deadline += timer.period;
+                if (isDue(timer, now))
+                {
+                    timer.deadline = now + timer.period;
+                }
+                link(task);
+            }
+            else
+            {
+                timer.active = false;
+            }
+            runs++;
+            if (timer.action)
+            {
+                (owner->*timer.action)();
+            }
+        }
+        return timeToNextDeadline(now);
+    }
+
+    /**
+     * @brief Get the time until the next task is due
+     *
+     * @param now - current time
+     * @return unsigned long - 0 if a task is due, NO_DEADLINE if no task is active
+     */
+    unsigned long timeToNextDeadline(unsigned long now) const
+    {
+        unsigned long next = NO_DEADLINE;
+        for (size_t task = 0; task < TASKS; task++)
+        {
+            const Timer &timer = timers[task];
+            if (timer.active)
+            {
+                unsigned long remaining = isDue(timer, now) ? 0 : timer.deadline - now;
+                next = remaining < next ? remaining : next;
+            }
+        }
+        return next;
+    }
+
+    /**
+     * @brief Get the number of task runs
+     *
+     * @return unsigned long
+     */
+    unsigned long getRuns() const { return runs; }
+
+    //======================PRIVATE==========================================================
+    private:
+
+    static const uint8_t NONE = 0xFF;       ///< end of a slot list
+
+    /**
+     * @brief State of one task
+     *
+     */
+    struct Timer
+    {
+        unsigned long deadline = 0;         ///< time the task is due
+        unsigned long period = 0;           ///< time between the runs, 0 for one-shot
+        Action action = nullptr;            ///< called when the task is due
+        bool active = false;                ///< task waits for its deadline
+        uint8_t previous = NONE;            ///< previous task in the slot
+        uint8_t next = NONE;                ///< next task in the slot
+    };
+
+    /**
+     * @brief Check whether the deadline of a timer is reached
+     *
+     */
+    static bool isDue(const Timer &timer, unsigned long now)
+    {
+        return (long)(now - timer.deadline) >= 0;
+    }
+
+    /**
+     * @brief Insert a task into the slot of its deadline
+     *
+     */
+    void link(size_t task)
+    {
+        Timer &timer = timers[task];
+        uint8_t &head = slots[timer.deadline % SLOTS];
+        timer.previous = NONE;
+        timer.next = head;
+        if (head != NONE)
+        {
+            timers[head].previous = (uint8_t)task;
+        }
+        head = (uint8_t)task;
+    }
+
+    /**
+     * @brief Remove a task from its slot
+     *
+     */
+    void unlink(size_t task)
+    {
+        Timer &timer = timers[task];
+        if (timer.previous != NONE)
+        {
+            timers[timer.previous].next = timer.next;
+        }
+        else
+        {
+            slots[timer.deadline % SLOTS] = timer.next;
+        }
+        if (timer.next != NONE)
+        {
+            timers[timer.next].previous = timer.previous;
+        }
+        timer.previous = NONE;
+        timer.next = NONE;
+    }
+
+    Owner *owner;                   ///< object the actions are called on
+    Timer timers[TASKS];            ///< state of the tasks
+    uint8_t slots[SLOTS];           ///< first task of every slot
+    unsigned long lastRun = 0;      ///< time of the last run()
+    unsigned long runs = 0;         ///< number of task runs
+};
+
+#endif // TIMERWHEEL_H__
@@ -0,0 +1,246 @@
+/**
+ * @file TopicTable.h
+ * @brief Table of interned mqtt topics with stable handles
+ * 
+ * Every topic is built once per kind and owner (sortic or box id) into a
+ * string reserved for TOPIC_LENGTH characters, afterwards only its handle is
+ * used. Looking up a topic compares the owner id and does not allocate.
+ * 
+ * get() may only be called by one thread. match() may run on another thread,
+ * an entry becomes visible to it only after it is completely built.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef TOPICTABLE_H__
+#define TOPICTABLE_H__
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief Enum class holds all kinds of topics, the owner is the sortic or box id
+ * 
+ */
+enum class TopicKind : uint8_t
+{
+    SorticStatus,       ///< Sortic/<owner>/status
+    SorticPosition,     ///< Sortic/<owner>/position
+    SorticPackage,      ///< Sortic/<owner>/package
+    SorticError,        ///< Sortic/<owner>/error
+    SorticHandshake,    ///< Sortic/<owner>/handshake
+    SorticBuffer,       ///< <owner>/buffer
+    BoxAvailable,       ///< Box/<owner>/available
+    BoxHandshake,       ///< Box/<owner>/handshake
+    BoxState,           ///< Box/<owner>/state
+    SorticProbe,        ///< Sortic/<owner>/probe
+    SorticTrace,        ///< Sortic/<owner>/trace
+    SorticMetrics       // keep last, used for TOPIC_KIND_COUNT; Sortic/<owner>/metrics
+};
+
+static constexpr size_t TOPIC_KIND_COUNT = (size_t)TopicKind::SorticMetrics + 1;     ///< number of topic kinds
+
+typedef uint16_t TopicHandle;               ///< stable handle of an interned topic
+
+/**
+ * @brief Table of interned topics
+ * 
+ * - the last slot is a scratch slot: if the table is full, the topic is built
+ *   there on every lookup, which is correct but not interned
+ * 
+ * @tparam TOPICS - number of interned topics
+ * @tparam TOPIC_LENGTH - reserved length of a topic
+ */
+template <size_t TOPICS, size_t TOPIC_LENGTH>
+class TopicTable
+{
+    static_assert(TOPICS > 0 && TOPICS < 65535, "TopicHandle is 16 bit");
+
+    //======================PUBLIC===========================================================
+    public:
+
+    static const size_t CAPACITY = TOPICS;     ///< number of interned topics, handles are below
+
+    /**
+     * @brief Construct a new Topic Table object and reserve the storage of all topics
+     * 
+     */
+    TopicTable()
+    {
+        for (size_t i = 0; i <= TOPICS; i++)
+        {
+            entries[i].name.reserve(TOPIC_LENGTH);
+            entries[i].owner.reserve(TOPIC_LENGTH);
+        }
+    }
+
+    /**
+     * @brief Get the handle of a topic, the topic is built on first use
+     * 
+     * @param kind - kind of the topic
+     * @param owner - sortic or box id, "+" for all boxes
+     * @return TopicHandle
+     */
+    TopicHandle get(TopicKind kind, const String &owner)
+    {
+        size_t interned = count.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < interned; i++)
+        {
+            if (entries[i].kind == kind && entries[i].owner == owner)
+            {
+                return (TopicHandle)i;
+            }
+        }
+        if (interned == TOPICS)
+        {
+            overflowed.store(true, std::memory_order_relaxed);
+        }
+        build(entries[interned], kind, owner);
+        if (interned < TOPICS)
+        {
+            count.store(interned + 1, std::memory_order_release);
+        }
+        return (TopicHandle)interned;
+    }
+
+    /**
+     * @brief Get the topic of a handle
+     * 
+     * @param handle - handle returned by get()
+     * @return const String&
+     */
+    const String &name(TopicHandle handle) const
+    {
+        return entries[handle].name;
+    }
+
+    /**
+     * @brief Find the interned topic a received topic belongs to
+     * 
+     * - the wildcards + and # of interned topics are matched
+     * - after the table overflowed every topic is accepted as scratch topic,
+     *   because the topics built in the scratch slot are not kept
+     * 
+     * @param topic - received topic, 0-terminated
+     * @param handle - handle of the matching topic
+     * @return true - topic matches an interned topic
+     * @return false - unknown topic
+     */
+    bool match(const char *topic, TopicHandle &handle) const
+    {
+        size_t interned = count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < interned; i++)
+        {
+            if (matches(entries[i].name.c_str(), topic))
+            {
+                handle = (TopicHandle)i;
+                return true;
+            }
+        }
+        handle = (TopicHandle)TOPICS;
+        return overflowed.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the number of interned topics
+     * 
+     * @return size_t
+     */
+    size_t size() const { return count.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Check whether a handle belongs to an interned topic and not to the scratch slot
+     * 
+     * @param handle - TopicHandle
+     * @return true 
+     * @return false 
+     */
+    bool isInterned(TopicHandle handle) const { return handle < count.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Check whether a topic did not fit into the table
+     * 
+     * @return true - increase the number of topics
+     * @return false 
+     */
+    bool isOverflowed() const { return overflowed.load(std::memory_order_relaxed); }
+
+    //======================PRIVATE==========================================================
+    private:
+
+    /**
+     * @brief One interned topic
+     * 
+     */
+    struct Entry
+    {
+        TopicKind kind = TopicKind::SorticStatus;   ///< kind of the topic
+        String owner;                               ///< sortic or box id
+        String name;                                ///< complete topic
+    };
+
+    /**
+     * @brief Build a topic into an entry
+     * 
+     * @param entry - entry to fill
+     * @param kind - kind of the topic
+     * @param owner - sortic or box id
+     */
+    static void build(Entry &entry, TopicKind kind, const String &owner)
+    {
+        static const char *const prefixes[] = {"Sortic/", "Sortic/", "Sortic/", "Sortic/", "Sortic/", "", "Box/", "Box/", "Box/", "Sortic/", "Sortic/", "Sortic/"};
+        static const char *const suffixes[] = {"/status", "/position", "/package", "/error", "/handshake", "/buffer", "/available", "/handshake", "/state", "/probe", "/trace", "/metrics"};
+        entry.kind = kind;
+        entry.owner = owner;
+        entry.name = prefixes[(size_t)kind];
+        entry.name += owner;
+        entry.name += suffixes[(size_t)kind];
+    }
+
+    /**
+     * @brief Match a topic against a filter with the wildcards + and #
+     * 
+     * @param filter - topic filter
+     * @param topic - topic
+     * @return true - topic matches the filter
+     * @return false
+     */
+    static bool matches(const char *filter, const char *topic)
+    {
+        while (*filter && *topic)
+        {
+            if (*filter == '#')
+            {
+                return true;
+            }
+            if (*filter == '+')
+            {
+                while (*topic && *topic != '/')
+                {
+                    topic++;
+                }
+                filter++;
+                continue;
+            }
+            if (*filter != *topic)
+            {
+                return false;
+            }
+            filter++;
+            topic++;
+        }
+        return (*filter == *topic) || (*filter == '#') || (filter[0] == '/' && filter[1] == '#' && !filter[2]);
+    }
+
+    Entry entries[TOPICS + 1];              ///< interned topics and the scratch slot
+    std::atomic<size_t> count{0};           ///< number of interned topics
+    std::atomic<bool> overflowed{false};    ///< a topic had to be built in the scratch slot
+};
+
+#endif // TOPICTABLE_H__
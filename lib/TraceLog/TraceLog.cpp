@@ -0,0 +1,16 @@
+/**
+ * @file TraceLog.cpp
+ * @brief RAM ring of compact trace records, the deferred backend of the DBxxx logging macros
+ *
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#include "LogConfiguration.h"
+
+#ifdef TRACE_LOG
+TraceLog<TRACE_LOG_SIZE> traceLog;      ///< records of all logging macros
+#endif
@@ -0,0 +1,329 @@
+/**
+ * @file TraceLog.h
+ * @brief RAM ring of compact trace records, the deferred backend of the DBxxx logging macros
+ *
+ * A record holds the time in us, the level, the address of the string
+ * literal of the logging site and one argument. Recording copies these few
+ * words and never formats, allocates or waits for the serial port. The text
+ * is only built when the ring is drained, by the CommunicationHub when it is
+ * about to sleep, or on demand with dump() on Serial or
+ * CommunicationHub::publishTrace() over mqtt.
+ *
+ * The site is the literal itself, so it needs no id table: the macros only
+ * accept string literals (runtime text is recorded as its length). Writers on
+ * both cores claim their slot with one atomic increment. A slot carries the
+ * sequence of its record, published after the fields: the drain stops at a
+ * record which is still written and skips one which was overwritten while it
+ * was read. A full ring overwrites its oldest records, drain() reports how
+ * many were lost.
+ *
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#ifndef TRACELOG_H__
+#define TRACELOG_H__
+
+#include <Arduino.h>
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Enum class holds the levels of the logging macros
+ *
+ */
+enum class TraceLevel : uint8_t
+{
+    Error,              ///< DBERROR
+    Warning,            ///< DBWARNING
+    Status,             ///< DBSTATUS
+    Event,              ///< DBEVENT
+    Info1,              ///< DBINFO1
+    Info2,              ///< DBINFO2
+    Info3,              ///< DBINFO3
+    FuncCall            ///< DBFUNCCALL
+};
+
+/**
+ * @brief One trace record
+ *
+ */
+struct TraceRecord
+{
+    uint32_t time = 0;                      ///< micros() of the record
+    const char *site = nullptr;             ///< string literal of the logging site
+    const char *detail = nullptr;           ///< static text argument, nullptr if arg is used
+    long arg = 0;                           ///< numeric argument
+    TraceLevel level = TraceLevel::Error;   ///< level of the logging site
+    bool hasArg = false;                    ///< arg or detail belongs to the record
+};
+
+/**
+ * @brief Ring of trace records
+ *
+ * @tparam CAPACITY - number of records, a power of two
+ */
+template <size_t CAPACITY>
+class TraceLog
+{
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "TraceLog needs a power of two capacity");
+
+    //======================PUBLIC===========================================================
+    public:
+
+    /**
+     * @brief Record a logging site
+     *
+     * @param level - TraceLevel
+     * @param site - string literal
+     */
+    template <size_t N>
+    void record(TraceLevel level, const char (&site)[N])
+    {
+        store(level, site, nullptr, 0, false);
+    }
+
+    /**
+     * @brief Record a logging site with a number
+     *
+     * @param level - TraceLevel
+     * @param site - string literal
+     * @param arg - number
+     */
+    template <size_t N>
+    void record(TraceLevel level, const char (&site)[N], long arg)
+    {
+        store(level, site, nullptr, arg, true);
+    }
+
+    /**
+     * @brief Record a logging site with a static text, e.g. the name of an enum value
+     *
+     * @param level - TraceLevel
+     * @param site - string literal
+     * @param detail - text which outlives the record
+     */
+    template <size_t N>
+    void record(TraceLevel level, const char (&site)[N], const char *detail)
+    {
+        store(level, site, detail, 0, true);
+    }
+
+    /**
+     * @brief Record runtime text, e.g. a topic in the buffer of the mqtt client
+     *
+     * - the text does not outlive the call, only its length is kept
+     *
+     * @param level - TraceLevel
+     * @param text - 0-terminated text
+     */
+    void record(TraceLevel level, char *text)
+    {
+        store(level, "runtime text of length ", nullptr, text ? (long)strlen(text) : 0, true);
+    }
+
+    /**
+     * @brief Format the oldest records and print them
+     *
+     * - stops at a record which is still written, the next drain goes on there
+     * - a record overwritten while it is read is counted as lost
+     *
+     * @param max - number of records to print at most
+     * @param output - takes the lines with print(const char *), e.g. Serial
+     * @return size_t - number of printed records
+     */
+    template <typename Output>
+    size_t drain(size_t max, Output &output)
+    {
+        uint32_t end = written.load(std::memory_order_acquire);
+        if (end - read > CAPACITY)
+        {
+            lost += end - read - CAPACITY;          // overwritten before they were drained
+            read = end - CAPACITY;
+        }
+        size_t printed = 0;
+        char line[TRACE_LINE_SIZE];
+        TraceRecord record;
+        for (; printed < max && read != end; read++)
+        {
+            typename Slot::State state = slots[read & (CAPACITY - 1)].load(read, record);
+            if (state == Slot::State::Writing)
+            {
+                break;
+            }
+            if (state == Slot::State::Overwritten)
+            {
+                lost++;
+                continue;
+            }
+            format(record, line, sizeof(line));
+            output.print(line);
+            printed++;
+        }
+        if (lost != reportedLost)
+        {
+            snprintf(line, sizeof(line), "trace: %lu records lost\n", lost);
+            output.print(line);
+            reportedLost = lost;
+        }
+        return printed;
+    }
+
+    /**
+     * @brief Format the oldest records and print them on Serial
+     *
+     * @param max - number of records to print at most
+     * @return size_t - number of printed records
+     */
+    size_t drain(size_t max) { return drain(max, Serial); }
+
+    /**
+     * @brief Print every record in the ring on Serial, call on demand
+     *
+     * @return size_t - number of printed records
+     */
+    size_t dump() { return drain(CAPACITY); }
+
+    /**
+     * @brief Format a record as one line
+     *
+     * @param record - TraceRecord
+     * @param line - output
+     * @param size - size of line
+     */
+    static void format(const TraceRecord &record, char *line, size_t size)
+    {
+        static const char *const levelNames[] = {"ERROR", "WARNING", "STATUS", "EVENT", "INFO1", "INFO2", "INFO3", "FUNC"};
+        if (!record.hasArg)
+        {
+            snprintf(line, size, "%10lu %-7s %s\n", (unsigned long)record.time, levelNames[(size_t)record.level], record.site);
+        }
+        else if (record.detail)
+        {
+            snprintf(line, size, "%10lu %-7s %s%s\n", (unsigned long)record.time, levelNames[(size_t)record.level], record.site, record.detail);
+        }
+        else
+        {
+            snprintf(line, size, "%10lu %-7s %s%ld\n", (unsigned long)record.time, levelNames[(size_t)record.level], record.site, record.arg);
+        }
+    }
+
+    /**
+     * @brief Get the number of records waiting to be drained
+     *
+     * @return size_t
+     */
+    size_t pending() const
+    {
+        uint32_t waiting = written.load(std::memory_order_acquire) - read;
+        return waiting < CAPACITY ? waiting : CAPACITY;
+    }
+
+    /**
+     * @brief Get the number of records overwritten before they were drained
+     *
+     * @return unsigned long
+     */
+    unsigned long getLost() const { return lost; }
+
+    //======================PRIVATE==========================================================
+    private:
+
+    static const size_t TRACE_LINE_SIZE = 160;      ///< longest formatted line
+
+    /**
+     * @brief Slot of the ring, a seqlock around one record
+     *
+     * - the fields are atomics with relaxed order, the sequence orders them
+     *
+     */
+    struct Slot
+    {
+        /**
+         * @brief Enum class holds the results of reading a slot
+         *
+         */
+        enum class State
+        {
+            Complete,       ///< the record was copied
+            Writing,        ///< the record is not written completely yet
+            Overwritten     ///< a newer record took the slot
+        };
+
+        /**
+         * @brief Write a record, the sequence publishes it
+         *
+         * @param index - claimed index of the record
+         */
+        void store(uint32_t index, TraceLevel level, const char *site, const char *detail, long arg, bool hasArg)
+        {
+            sequence.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            time.store((uint32_t)micros(), std::memory_order_relaxed);
+            this->site.store(site, std::memory_order_relaxed);
+            this->detail.store(detail, std::memory_order_relaxed);
+            this->arg.store(arg, std::memory_order_relaxed);
+            flags.store((uint8_t)((uint8_t)level | (hasArg ? HAS_ARG : 0)), std::memory_order_relaxed);
+            sequence.store(index + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Copy the record of an index
+         *
+         * @param index - index of the record
+         * @param record - output, valid for State::Complete
+         * @return State
+         */
+        State load(uint32_t index, TraceRecord &record) const
+        {
+            uint32_t expected = index + 1;
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before == 0 || (int32_t)(before - expected) < 0)
+            {
+                return State::Writing;
+            }
+            if (before != expected)
+            {
+                return State::Overwritten;
+            }
+            record.time = time.load(std::memory_order_relaxed);
+            record.site = site.load(std::memory_order_relaxed);
+            record.detail = detail.load(std::memory_order_relaxed);
+            record.arg = arg.load(std::memory_order_relaxed);
+            uint8_t bits = flags.load(std::memory_order_relaxed);
+            record.level = (TraceLevel)(bits & ~HAS_ARG);
+            record.hasArg = (bits & HAS_ARG) != 0;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return sequence.load(std::memory_order_relaxed) == expected ? State::Complete : State::Overwritten;
+        }
+
+        static const uint8_t HAS_ARG = 0x80;        ///< bit of flags set if arg or detail belongs to the record
+
+        std::atomic<uint32_t> sequence{0};          ///< index + 1 of the complete record, 0 while a record is written
+        std::atomic<uint32_t> time{0};              ///< micros() of the record
+        std::atomic<const char *> site{nullptr};    ///< string literal of the logging site
+        std::atomic<const char *> detail{nullptr};  ///< static text argument
+        std::atomic<long> arg{0};                   ///< numeric argument
+        std::atomic<uint8_t> flags{0};              ///< TraceLevel and HAS_ARG
+    };
+
+    void store(TraceLevel level, const char *site, const char *detail, long arg, bool hasArg)
+    {
+        uint32_t index = written.fetch_add(1, std::memory_order_relaxed);
+        slots[index & (CAPACITY - 1)].store(index, level, site, detail, arg, hasArg);
+    }
+
+    Slot slots[CAPACITY];                           ///< ring of records
+    std::atomic<uint32_t> written{0};               ///< number of claimed records, the next slot
+    uint32_t read = 0;                              ///< number of drained records, only the drain moves it
+    unsigned long lost = 0;                         ///< records overwritten before they were drained
+    unsigned long reportedLost = 0;                 ///< lost when drain() last reported it
+};
+
+#endif // TRACELOG_H__
@@ -0,0 +1,230 @@
+/**
+ * @file Arduino.cpp
+ * @brief Host stand-in for the Arduino core used by the native build
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "Arduino.h"
+
+#include <stdio.h>
+#include <ctype.h>
+#include <chrono>
+
+//======================String===========================================================
+
+String::String(float value, unsigned char decimalPlaces)
+{
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, (double)value);
+    buffer = buf;
+}
+
+String::String(double value, unsigned char decimalPlaces)
+{
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+    buffer = buf;
+}
+
+unsigned char String::equalsIgnoreCase(const String &s) const
+{
+    if (buffer.length() != s.buffer.length())
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < buffer.length(); i++)
+    {
+        if (tolower((unsigned char)buffer[i]) != tolower((unsigned char)s.buffer[i]))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+unsigned char String::endsWith(const String &suffix) const
+{
+    if (suffix.buffer.length() > buffer.length())
+    {
+        return 0;
+    }
+    return buffer.compare(buffer.length() - suffix.buffer.length(), suffix.buffer.length(), suffix.buffer) == 0;
+}
+
+int String::indexOf(char c, unsigned int fromIndex) const
+{
+    size_t pos = buffer.find(c, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String &str, unsigned int fromIndex) const
+{
+    size_t pos = buffer.find(str.buffer, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int beginIndex) const
+{
+    return substring(beginIndex, buffer.length());
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const
+{
+    if (beginIndex > endIndex)
+    {
+        unsigned int temp = endIndex;
+        endIndex = beginIndex;
+        beginIndex = temp;
+    }
+    if (beginIndex >= buffer.length())
+    {
+        return String();
+    }
+    if (endIndex > buffer.length())
+    {
+        endIndex = buffer.length();
+    }
+    return String(buffer.substr(beginIndex, endIndex - beginIndex));
+}
+
+void String::toCharArray(char *buf, unsigned int bufsize, unsigned int index) const
+{
+    if (!bufsize || !buf)
+    {
+        return;
+    }
+    size_t n = 0;
+    if (index < buffer.length())
+    {
+        n = buffer.copy(buf, bufsize - 1, index);
+    }
+    buf[n] = '\0';
+}
+
+void String::trim()
+{
+    size_t begin = buffer.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos)
+    {
+        buffer.clear();
+        return;
+    }
+    size_t end = buffer.find_last_not_of(" \t\r\n");
+    buffer = buffer.substr(begin, end - begin + 1);
+}
+
+void String::toLowerCase()
+{
+    for (char &c : buffer)
+    {
+        c = (char)tolower((unsigned char)c);
+    }
+}
+
+void String::toUpperCase()
+{
+    for (char &c : buffer)
+    {
+        c = (char)toupper((unsigned char)c);
+    }
+}
+
+//======================Serial===========================================================
+
+HardwareSerial Serial;
+
+void HardwareSerial::print(const String &s)
+{
+    print(s.c_str());
+}
+
+void HardwareSerial::print(const char *s)
+{
+    if (enabled && s)
+    {
+        fputs(s, stdout);
+    }
+}
+
+void HardwareSerial::print(char c)
+{
+    if (enabled)
+    {
+        fputc(c, stdout);
+    }
+}
+
+//======================Random===========================================================
+
+static unsigned long randomState = 1;      ///< state of the linear congruential generator
+
+void randomSeed(unsigned long seed)
+{
+    randomState = seed;
+}
+
+long random(long howbig)
+{
+    if (howbig <= 0)
+    {
+        return 0;
+    }
+    randomState = randomState * 1103515245UL + 12345UL;
+    return (long)((randomState >> 16) % (unsigned long)howbig);
+}
+
+long random(long howsmall, long howbig)
+{
+    return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+//======================Clock============================================================
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();   ///< host time at program start
+static unsigned long long skippedMicros = 0;                                                        ///< virtual time added by delay()
+static bool simulatedTime = false;                                                                  ///< ignore the host time
+
+static unsigned long long elapsedMicros()
+{
+    if (simulatedTime)
+    {
+        return skippedMicros;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+    return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() + skippedMicros;
+}
+
+unsigned long millis()
+{
+    return (unsigned long)(elapsedMicros() / 1000ULL);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)elapsedMicros();
+}
+
+void delay(unsigned long ms)
+{
+    skippedMicros += (unsigned long long)ms * 1000ULL;
+}
+
+unsigned long long NativeClock::skippedMillis()
+{
+    return skippedMicros / 1000ULL;
+}
+
+void NativeClock::advance(unsigned long ms)
+{
+    delay(ms);
+}
+
+void NativeClock::setSimulated(bool simulated)
+{
+    simulatedTime = simulated;
+}
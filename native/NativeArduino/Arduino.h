@@ -0,0 +1,206 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the Arduino core used by the native build
+ * 
+ * - Arduino String on top of std::string
+ * - Serial which prints to stdout
+ * - millis(), micros() and delay() on a virtual clock, so delay() advances
+ *   hub time without sleeping the host
+ * - random() with a fixed seed, so benchmark runs repeat
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef NATIVE_ARDUINO_H__
+#define NATIVE_ARDUINO_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+/**
+ * @brief Host implementation of the Arduino String class
+ * 
+ */
+class String
+{
+    public:
+    String() {}
+    String(const char *cstr) : buffer(cstr ? cstr : "") {}
+    String(const std::string &str) : buffer(str) {}
+    explicit String(char c) : buffer(1, c) {}
+    explicit String(int value) : buffer(std::to_string(value)) {}
+    explicit String(unsigned int value) : buffer(std::to_string(value)) {}
+    explicit String(long value) : buffer(std::to_string(value)) {}
+    explicit String(unsigned long value) : buffer(std::to_string(value)) {}
+    explicit String(long long value) : buffer(std::to_string(value)) {}
+    explicit String(unsigned long long value) : buffer(std::to_string(value)) {}
+    explicit String(unsigned char value) : buffer(std::to_string(value)) {}
+    explicit String(float value, unsigned char decimalPlaces = 2);
+    explicit String(double value, unsigned char decimalPlaces = 2);
+
+    unsigned int length() const { return buffer.length(); }
+    const char *c_str() const { return buffer.c_str(); }
+    unsigned char reserve(unsigned int size) { buffer.reserve(size); return 1; }
+
+    unsigned char concat(const String &str) { buffer += str.buffer; return 1; }
+    unsigned char concat(const char *cstr) { if (cstr) buffer += cstr; return 1; }
+    unsigned char concat(const char *cstr, unsigned int length) { if (cstr) buffer.append(cstr, length); return 1; }
+    unsigned char concat(char c) { buffer += c; return 1; }
+    template <typename T>
+    unsigned char concat(T value) { return concat(String(value)); }
+
+    String &operator+=(const String &rhs) { concat(rhs); return *this; }
+    String &operator+=(const char *cstr) { concat(cstr); return *this; }
+    String &operator+=(char c) { concat(c); return *this; }
+
+    unsigned char equals(const String &s) const { return buffer == s.buffer; }
+    unsigned char equals(const char *cstr) const { return buffer == (cstr ? cstr : ""); }
+    unsigned char equalsIgnoreCase(const String &s) const;
+    unsigned char startsWith(const String &prefix) const { return buffer.compare(0, prefix.buffer.length(), prefix.buffer) == 0; }
+    unsigned char endsWith(const String &suffix) const;
+    int compareTo(const String &s) const { return buffer.compare(s.buffer); }
+
+    bool operator==(const String &rhs) const { return buffer == rhs.buffer; }
+    bool operator==(const char *cstr) const { return equals(cstr); }
+    bool operator!=(const String &rhs) const { return buffer != rhs.buffer; }
+    bool operator!=(const char *cstr) const { return !equals(cstr); }
+    bool operator<(const String &rhs) const { return buffer < rhs.buffer; }
+
+    char charAt(unsigned int index) const { return index < buffer.length() ? buffer[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char &operator[](unsigned int index) { return buffer[index]; }
+
+    int indexOf(char c, unsigned int fromIndex = 0) const;
+    int indexOf(const String &str, unsigned int fromIndex = 0) const;
+    String substring(unsigned int beginIndex) const;
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+    void toCharArray(char *buf, unsigned int bufsize, unsigned int index = 0) const;
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+    long toInt() const { return strtol(buffer.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(buffer.c_str(), nullptr); }
+    double toDouble() const { return strtod(buffer.c_str(), nullptr); }
+
+    private:
+    std::string buffer;     ///< string storage
+};
+
+inline String operator+(const String &lhs, const String &rhs) { String s(lhs); s.concat(rhs); return s; }
+inline String operator+(const String &lhs, const char *rhs) { String s(lhs); s.concat(rhs); return s; }
+inline String operator+(const char *lhs, const String &rhs) { String s(lhs); s.concat(rhs); return s; }
+inline String operator+(const String &lhs, char rhs) { String s(lhs); s.concat(rhs); return s; }
+
+/**
+ * @brief Host implementation of the Arduino Serial object, prints to stdout
+ * 
+ */
+class HardwareSerial
+{
+    public:
+    void begin(unsigned long baud) { (void)baud; }
+    operator bool() const { return enabled; }
+
+    void print(const String &s);
+    void print(const char *s);
+    void print(char c);
+    void print(int value) { print(String(value)); }
+    void print(unsigned int value) { print(String(value)); }
+    void print(long value) { print(String(value)); }
+    void print(unsigned long value) { print(String(value)); }
+    void print(double value) { print(String(value)); }
+    void println() { print('\n'); }
+    template <typename T>
+    void println(const T &value) { print(value); println(); }
+
+    bool enabled = true;    ///< set false to silence the debug output, e.g. for benchmarks
+};
+
+extern HardwareSerial Serial;
+
+/**
+ * @brief Milliseconds since start on the virtual clock
+ * 
+ * @return unsigned long 
+ */
+unsigned long millis();
+
+/**
+ * @brief Microseconds since start on the virtual clock
+ * 
+ * @return unsigned long 
+ */
+unsigned long micros();
+
+/**
+ * @brief Advances the virtual clock, the host thread does not sleep
+ * 
+ * @param ms - milliseconds
+ */
+void delay(unsigned long ms);
+
+/**
+ * @brief Seed the pseudo random numbers of random()
+ * 
+ * @param seed 
+ */
+void randomSeed(unsigned long seed);
+
+/**
+ * @brief Pseudo random number, the sequence is the same on every run unless randomSeed() is called
+ * 
+ * @param howbig - upper limit, excluded
+ * @return long - 0 to howbig - 1, 0 if howbig is 0
+ */
+long random(long howbig);
+
+/**
+ * @brief Pseudo random number in a range
+ * 
+ * @param howsmall - lower limit, included
+ * @param howbig - upper limit, excluded
+ * @return long 
+ */
+long random(long howsmall, long howbig);
+
+/**
+ * @brief Host side control of the virtual clock
+ * 
+ */
+namespace NativeClock
+{
+    /**
+     * @brief Milliseconds skipped by delay() and advance() so far
+     * 
+     * @return unsigned long long 
+     */
+    unsigned long long skippedMillis();
+
+    /**
+     * @brief Advance the virtual clock without calling into the hub
+     * 
+     * @param ms - milliseconds
+     */
+    void advance(unsigned long ms);
+
+    /**
+     * @brief Switch between host time plus skipped time and purely simulated time
+     * 
+     * In simulated mode the clock only moves through delay() and advance(),
+     * which makes benchmark runs independent of the host speed.
+     * 
+     * @param simulated 
+     */
+    void setSimulated(bool simulated);
+}
+
+#endif // NATIVE_ARDUINO_H__
@@ -0,0 +1,44 @@
+/**
+ * @file I2cCommunication.cpp
+ * @brief Host stand-in for SmartFactory_I2cCommunication used by the native build
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "I2cCommunication.h"
+
+std::function<void(int, ReceivedI2cMessage &)> I2cCommunication::onRead;
+std::function<void(int, const WriteI2cMessage &)> I2cCommunication::onWrite;
+unsigned long I2cCommunication::readCount = 0;
+unsigned long I2cCommunication::writeCount = 0;
+
+I2cCommunication::I2cCommunication(int slaveAddress, ReceivedI2cMessage *pReceivedMessage, WriteI2cMessage *pWriteMessage)
+    : slaveAddress(slaveAddress), pReceivedMessage(pReceivedMessage), pWriteMessage(pWriteMessage)
+{
+}
+
+void I2cCommunication::readMessage()
+{
+    readCount++;
+    if (onRead)
+    {
+        onRead(slaveAddress, *pReceivedMessage);
+    }
+    else
+    {
+        *pReceivedMessage = ReceivedI2cMessage();
+    }
+}
+
+void I2cCommunication::writeMessage()
+{
+    writeCount++;
+    if (onWrite)
+    {
+        onWrite(slaveAddress, *pWriteMessage);
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ * @file I2cCommunication.h
+ * @brief Host stand-in for SmartFactory_I2cCommunication used by the native build
+ * 
+ * The bus is replaced by an in-process slave: readMessage() asks the installed
+ * slave handler for the next message and writeMessage() hands the write message
+ * to it. Without a handler the slave answers with the default event.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef NATIVE_I2CCOMMUNICATION_H__
+#define NATIVE_I2CCOMMUNICATION_H__
+
+#include <Arduino.h>
+#include <functional>
+
+/**
+ * @brief Message received from the i2c slave
+ * 
+ */
+struct ReceivedI2cMessage
+{
+    char event[12] = "null#######";     ///< event of the slave
+    uint8_t state = 0;                  ///< state of the sortic roboter
+    uint8_t position = 0;               ///< position of the sortic roboter
+    unsigned int packageId = 0;         ///< id of the package
+    uint8_t targetDest = 0;             ///< target destination of the package
+    bool error = false;                 ///< error flag
+    bool token = false;                 ///< error token
+};
+
+/**
+ * @brief Message written to the i2c slave
+ * 
+ */
+struct WriteI2cMessage
+{
+    char event[12] = "null#######";     ///< event for the slave
+    uint8_t targetLine = 0;             ///< target line of the package
+};
+
+/**
+ * @brief In-process i2c master
+ * 
+ */
+class I2cCommunication
+{
+    public:
+
+    /**
+     * @brief Construct a new I2c Communication object
+     * 
+     * @param slaveAddress - i2c address of the slave
+     * @param pReceivedMessage - message the slave answers into
+     * @param pWriteMessage - message written to the slave
+     */
+    I2cCommunication(int slaveAddress, ReceivedI2cMessage *pReceivedMessage, WriteI2cMessage *pWriteMessage);
+
+    /**
+     * @brief Request a message from the slave
+     * 
+     */
+    void readMessage();
+
+    /**
+     * @brief Write the write message to the slave
+     * 
+     */
+    void writeMessage();
+
+    static std::function<void(int slaveAddress, ReceivedI2cMessage &)> onRead;             ///< slave answer to a read request
+    static std::function<void(int slaveAddress, const WriteI2cMessage &)> onWrite;         ///< slave reception of a write
+    static unsigned long readCount;                                                         ///< number of read transactions
+    static unsigned long writeCount;                                                        ///< number of write transactions
+
+    private:
+    int slaveAddress;                               ///< i2c address of the slave
+    ReceivedI2cMessage *pReceivedMessage;           ///< target of read transactions
+    WriteI2cMessage *pWriteMessage;                 ///< source of write transactions
+};
+
+#endif // NATIVE_I2CCOMMUNICATION_H__
@@ -0,0 +1,274 @@
+/**
+ * @file MQTTCommunication.cpp
+ * @brief Host stand-in for SmartFactory_MQTTCommunication used by the native build
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "MQTTCommunication.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+std::function<void(Communication &, const String &, const String &)> Communication::onPublish;
+std::function<void(Communication &, const String &)> Communication::onSubscribe;
+unsigned long Communication::publishCount = 0;
+unsigned long Communication::subscribeCount = 0;
+unsigned long Communication::unsubscribeCount = 0;
+bool Communication::cStringPayloads = false;
+
+static std::vector<Communication *> clients;    ///< all clients connected to the in-process broker
+static std::recursive_mutex brokerLock;         ///< the broker is reached from the mqtt task and the test driver in DUAL_CORE mode
+static std::atomic<unsigned long> polls{0};     ///< number of loop() calls of all clients
+
+/**
+ * @brief Match a topic against a subscription filter with + and # wildcards
+ * 
+ */
+static bool topicMatches(const std::string &filter, const char *topic)
+{
+    size_t f = 0;
+    const char *t = topic;
+    while (f < filter.size())
+    {
+        if (filter[f] == '#')
+        {
+            return true;
+        }
+        if (filter[f] == '+')
+        {
+            while (*t && *t != '/')
+            {
+                t++;
+            }
+            f++;
+            continue;
+        }
+        if (!*t || filter[f] != *t)
+        {
+            return false;
+        }
+        f++;
+        t++;
+    }
+    return *t == '\0';
+}
+
+Communication::Communication(String hostname, void (*callback)(char *, byte *, unsigned int))
+    : hostname(hostname), callback(callback)
+{
+    std::lock_guard<std::recursive_mutex> guard(brokerLock);
+    clients.push_back(this);
+}
+
+Communication::~Communication()
+{
+    std::lock_guard<std::recursive_mutex> guard(brokerLock);
+    clients.erase(std::remove(clients.begin(), clients.end(), this), clients.end());
+}
+
+void Communication::loop()
+{
+    polls++;
+
+    // like the real client, a poll after a dropped connection only reconnects
+    if (!online)
+    {
+        online = true;
+        return;
+    }
+
+    // deliver only what was queued before this call, like one client poll
+    std::unique_lock<std::recursive_mutex> guard(brokerLock);
+    size_t pending = inbox.size();
+    while (pending-- && !inbox.empty())
+    {
+        std::pair<std::string, std::string> message = inbox.front();
+        inbox.pop_front();
+        bool subscribed = isSubscribed(message.first.c_str());
+        guard.unlock();
+        if (subscribed && callback)
+        {
+            callback(&message.first[0], (byte *)&message.second[0], message.second.size());
+        }
+        guard.lock();
+    }
+}
+
+void Communication::subscribe(String topic)
+{
+    if (!online)
+    {
+        return;     // no session, the request is lost
+    }
+    subscribeCount++;
+    {
+        std::lock_guard<std::recursive_mutex> guard(brokerLock);
+        subscriptions.insert(topic.c_str());
+    }
+    if (onSubscribe)
+    {
+        onSubscribe(*this, topic);
+    }
+}
+
+void Communication::unsubscribe(String topic)
+{
+    unsubscribeCount++;
+    std::lock_guard<std::recursive_mutex> guard(brokerLock);
+    subscriptions.erase(topic.c_str());
+}
+
+void Communication::publishMessage(String topic, String msg)
+{
+    if (!online)
+    {
+        return;     // no session, the publish is lost
+    }
+    if (cStringPayloads)
+    {
+        msg = String(msg.c_str());
+    }
+    publishCount++;
+    if (onPublish)
+    {
+        onPublish(*this, topic, msg);
+    }
+    deliver(topic, msg);
+}
+
+void Communication::publishMessage(const String &topic, const uint8_t *payload, size_t length)
+{
+    if (!online)
+    {
+        return;     // no session, the publish is lost
+    }
+    publishCount++;
+    if (onPublish)
+    {
+        String msg;
+        msg.concat((const char *)payload, (unsigned int)length);
+        onPublish(*this, topic, msg);
+    }
+    queue(topic.c_str(), (const char *)payload, length);
+}
+
+bool Communication::beginPublish(const String &topic, size_t length)
+{
+    if (streaming || cStringPayloads)
+    {
+        return false;
+    }
+    streaming = true;
+    streamTopic = topic;
+    streamLength = length;
+    streamPayload.clear();
+    streamPayload.reserve(length);
+    return true;
+}
+
+size_t Communication::write(const uint8_t *data, size_t length)
+{
+    if (!streaming || streamPayload.size() + length > streamLength)
+    {
+        return 0;
+    }
+    streamPayload.append((const char *)data, length);
+    return length;
+}
+
+bool Communication::endPublish()
+{
+    if (!streaming)
+    {
+        return false;
+    }
+    streaming = false;
+    if (streamPayload.size() != streamLength)
+    {
+        return false;
+    }
+    if (!online)
+    {
+        return true;    // no session, the publish is lost
+    }
+    publishCount++;
+    if (onPublish)
+    {
+        String msg;
+        msg.concat(streamPayload.data(), (unsigned int)streamPayload.size());
+        onPublish(*this, streamTopic, msg);
+    }
+    queue(streamTopic.c_str(), streamPayload.data(), streamPayload.size());
+    return true;
+}
+
+bool Communication::isSubscribed(const char *topic) const
+{
+    std::lock_guard<std::recursive_mutex> guard(brokerLock);
+    for (const std::string &filter : subscriptions)
+    {
+        if (topicMatches(filter, topic))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Communication::deliver(const String &topic, const String &payload)
+{
+    queue(topic.c_str(), payload.c_str(), payload.length());
+}
+
+void Communication::queue(const char *topic, const char *payload, size_t length)
+{
+    std::lock_guard<std::recursive_mutex> guard(brokerLock);
+    for (Communication *client : clients)
+    {
+        if (client->isSubscribed(topic))
+        {
+            client->inbox.emplace_back(topic, std::string(payload, length));     // the payload may be binary
+        }
+    }
+}
+
+void Communication::dropConnections()
+{
+    std::lock_guard<std::recursive_mutex> guard(brokerLock);
+    for (Communication *client : clients)
+    {
+        client->online = false;
+        client->subscriptions.clear();
+        client->inbox.clear();
+    }
+}
+
+void Communication::awaitPolls(unsigned long count)
+{
+    unsigned long target = polls + count;
+    while ((long)(polls - target) < 0)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void Communication::reset()
+{
+    std::lock_guard<std::recursive_mutex> guard(brokerLock);
+    for (Communication *client : clients)
+    {
+        client->inbox.clear();
+    }
+    publishCount = 0;
+    subscribeCount = 0;
+    unsubscribeCount = 0;
+    cStringPayloads = false;
+}
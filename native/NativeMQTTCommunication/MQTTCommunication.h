@@ -0,0 +1,189 @@
+/**
+ * @file MQTTCommunication.h
+ * @brief Host stand-in for SmartFactory_MQTTCommunication used by the native build
+ * 
+ * The broker is replaced by an in-process one: published messages go to the
+ * installed publish handler and, like on a real broker, to every client
+ * whose subscriptions match, the publishing one included. Messages injected
+ * with deliver() reach the callback of these clients on their next loop().
+ * 
+ * Like the PubSubClient below the real library, a message can be streamed
+ * with beginPublish(), write() and endPublish(); MqttClientTraits finds the
+ * calls at compile time. A binary payload can also be published
+ * whole with its length. With cStringPayloads set the client behaves like
+ * one which hands msg.c_str() on: a text publish ends at its first zero byte
+ * and beginPublish() is refused. A dropped connection is restored by the
+ * next loop() with a new session and without subscriptions, requests and
+ * publishes in between are lost.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef NATIVE_MQTTCOMMUNICATION_H__
+#define NATIVE_MQTTCOMMUNICATION_H__
+
+#include <Arduino.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <set>
+#include <string>
+
+/**
+ * @brief In-process mqtt client
+ * 
+ */
+class Communication
+{
+    public:
+
+    /**
+     * @brief Construct a new Communication object
+     * 
+     * @param hostname - client name
+     * @param callback - called for every received message
+     */
+    Communication(String hostname, void (*callback)(char *topic, byte *payload, unsigned int length));
+
+    /**
+     * @brief Destroy the Communication object
+     * 
+     */
+    ~Communication();
+
+    /**
+     * @brief Deliver pending messages to the callback, reconnect first if the connection was dropped
+     * 
+     */
+    void loop();
+
+    /**
+     * @brief Subscribe to a topic, wildcards + and # are supported
+     * 
+     * @param topic 
+     */
+    void subscribe(String topic);
+
+    /**
+     * @brief Unsubscribe from a topic
+     * 
+     * @param topic 
+     */
+    void unsubscribe(String topic);
+
+    /**
+     * @brief Publish a message
+     * 
+     * @param topic 
+     * @param msg 
+     */
+    void publishMessage(String topic, String msg);
+
+    /**
+     * @brief Publish a binary payload
+     * 
+     * @param topic 
+     * @param payload - payload, may contain zero bytes
+     * @param length - length of the payload
+     */
+    void publishMessage(const String &topic, const uint8_t *payload, size_t length);
+
+    /**
+     * @brief Start a streamed publish, the fixed header goes out with the length of the payload
+     * 
+     * @param topic 
+     * @param length - length of the whole payload
+     * @return true 
+     * @return false - a streamed publish is open already or cStringPayloads is set
+     */
+    bool beginPublish(const String &topic, size_t length);
+
+    /**
+     * @brief Write a part of the payload of the streamed publish
+     * 
+     * @param data 
+     * @param length 
+     * @return size_t - bytes taken, 0 without open publish or beyond the announced length
+     */
+    size_t write(const uint8_t *data, size_t length);
+
+    /**
+     * @brief Finish the streamed publish
+     * 
+     * @return true 
+     * @return false - the written payload does not match the announced length, the publish is dropped
+     */
+    bool endPublish();
+
+    /**
+     * @brief Check whether a topic is covered by the current subscriptions
+     * 
+     * @param topic 
+     * @return true 
+     * @return false 
+     */
+    bool isSubscribed(const char *topic) const;
+
+    /**
+     * @brief Queue a message on the broker for every matching client
+     * 
+     * @param topic 
+     * @param payload 
+     */
+    static void deliver(const String &topic, const String &payload);
+
+    /**
+     * @brief Drop the connection of every client, the broker forgets their subscriptions and queued messages
+     * 
+     */
+    static void dropConnections();
+
+    /**
+     * @brief Wait until the clients were polled a number of times, called from another thread than the polling one
+     * 
+     * - keeps a driver on the simulated clock in step with the mqtt task in DUAL_CORE mode
+     * 
+     * @param count - number of loop() calls to wait for
+     */
+    static void awaitPolls(unsigned long count);
+
+    /**
+     * @brief Drop all queued messages, reset the counters and cStringPayloads
+     * 
+     */
+    static void reset();
+
+    static std::function<void(Communication &, const String &topic, const String &msg)> onPublish;    ///< broker reception of a publish
+    static std::function<void(Communication &, const String &topic)> onSubscribe;                     ///< broker reception of a subscribe
+    static unsigned long publishCount;                                                                 ///< number of PUBLISH packets
+    static unsigned long subscribeCount;                                                               ///< number of SUBSCRIBE packets
+    static unsigned long unsubscribeCount;                                                             ///< number of UNSUBSCRIBE packets
+    static bool cStringPayloads;                                                                       ///< text publishes end at the first zero byte, no streaming
+
+    private:
+
+    /**
+     * @brief Queue a message for every matching client
+     * 
+     * @param topic - 0-terminated topic
+     * @param payload - payload, may be binary
+     * @param length - length of the payload
+     */
+    static void queue(const char *topic, const char *payload, size_t length);
+
+    String hostname;                                                ///< client name
+    void (*callback)(char *topic, byte *payload, unsigned int length);  ///< message callback
+    std::set<std::string> subscriptions;                            ///< active subscriptions
+    std::deque<std::pair<std::string, std::string>> inbox;          ///< messages waiting for loop()
+    String streamTopic;                                             ///< topic of the open streamed publish
+    std::string streamPayload;                                      ///< payload of the open streamed publish
+    size_t streamLength = 0;                                        ///< announced length of the open streamed publish
+    bool streaming = false;                                         ///< a streamed publish is open
+    std::atomic<bool> online{true};                                 ///< connected to the broker
+};
+
+#endif // NATIVE_MQTTCOMMUNICATION_H__
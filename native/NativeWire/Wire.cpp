@@ -0,0 +1,41 @@
+/**
+ * @file Wire.cpp
+ * @brief Host stand-in for the Arduino Wire library used by the native build
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "Wire.h"
+
+TwoWire Wire;
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity)
+{
+    rxBuffer.assign(quantity, 0xFF);    // idle bus reads as 0xFF
+    rxPosition = 0;
+    size_t received = onRequest ? onRequest(address, rxBuffer.data(), quantity) : 0;
+    rxBuffer.resize(received < quantity ? received : quantity);
+    bytesRead += rxBuffer.size();
+    return (uint8_t)rxBuffer.size();
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    txAddress = address;
+    txBuffer.clear();
+}
+
+uint8_t TwoWire::endTransmission()
+{
+    bytesWritten += txBuffer.size();
+    if (onReceive)
+    {
+        onReceive(txAddress, txBuffer.data(), txBuffer.size());
+    }
+    txBuffer.clear();
+    return 0;
+}
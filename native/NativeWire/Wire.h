@@ -0,0 +1,52 @@
+/**
+ * @file Wire.h
+ * @brief Host stand-in for the Arduino Wire library used by the native build
+ * 
+ * A transaction is handed to the installed slave handlers: requestFrom() asks
+ * onRequest for the answer, endTransmission() passes the written bytes to onReceive.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef NATIVE_WIRE_H__
+#define NATIVE_WIRE_H__
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief In-process i2c master
+ * 
+ */
+class TwoWire
+{
+    public:
+    void begin() {}
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+    int available() const { return (int)(rxBuffer.size() - rxPosition); }
+    int read() { return rxPosition < rxBuffer.size() ? rxBuffer[rxPosition++] : -1; }
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t data) { txBuffer.push_back(data); return 1; }
+    size_t write(const uint8_t *data, size_t quantity) { txBuffer.insert(txBuffer.end(), data, data + quantity); return quantity; }
+    uint8_t endTransmission();
+
+    std::function<size_t(uint8_t address, uint8_t *buffer, size_t quantity)> onRequest;        ///< slave answer, returns number of bytes
+    std::function<void(uint8_t address, const uint8_t *buffer, size_t length)> onReceive;     ///< slave reception
+    unsigned long bytesRead = 0;                                                                ///< bytes transferred slave to master
+    unsigned long bytesWritten = 0;                                                             ///< bytes transferred master to slave
+
+    private:
+    std::vector<uint8_t> rxBuffer;      ///< answer of the last request
+    size_t rxPosition = 0;              ///< read position in rxBuffer
+    std::vector<uint8_t> txBuffer;      ///< bytes of the open transmission
+    uint8_t txAddress = 0;              ///< address of the open transmission
+};
+
+extern TwoWire Wire;
+
+#endif // NATIVE_WIRE_H__
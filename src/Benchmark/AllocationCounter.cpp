@@ -0,0 +1,65 @@
+/**
+ * @file AllocationCounter.cpp
+ * @brief Replacement of the global operator new and delete which counts the allocations
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "AllocationCounter.h"
+
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+
+static std::atomic<unsigned long> gAllocations(0);     ///< number of allocations
+static std::atomic<unsigned long> gBytes(0);           ///< number of allocated bytes
+
+unsigned long AllocationCounter::allocations() { return gAllocations.load(); }
+unsigned long AllocationCounter::bytes() { return gBytes.load(); }
+
+/**
+ * @brief Allocate and count
+ * 
+ * @param size 
+ * @return void* - nullptr if malloc fails
+ */
+static void *countedAlloc(size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(size, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void *operator new(size_t size)
+{
+    void *p = countedAlloc(size);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
@@ -0,0 +1,37 @@
+/**
+ * @file AllocationCounter.h
+ * @brief Counts the heap allocations of the native benchmark binary
+ * 
+ * AllocationCounter.cpp replaces the global operator new and delete, so every
+ * allocation of the process is counted, including the ones of the libraries.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef ALLOCATIONCOUNTER_H__
+#define ALLOCATIONCOUNTER_H__
+
+#include <stddef.h>
+
+namespace AllocationCounter
+{
+/**
+ * @brief Get the number of allocations since program start
+ * 
+ * @return unsigned long 
+ */
+unsigned long allocations();
+
+/**
+ * @brief Get the number of allocated bytes since program start
+ * 
+ * @return unsigned long 
+ */
+unsigned long bytes();
+} // namespace AllocationCounter
+
+#endif // ALLOCATIONCOUNTER_H__
@@ -0,0 +1,70 @@
+/**
+ * @file BenchmarkMain.cpp
+ * @brief Entry point of the native benchmark binary
+ * 
+ * usage: program [suite] [iterations]
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DispatchBenchmark.h"
+#include "FsmBenchmark.h"
+#include "LogBenchmark.h"
+#include "PublishBenchmark.h"
+#include "ScalingBenchmark.h"
+#include "WireBenchmark.h"
+
+int main(int argc, char **argv)
+{
+    const char *suite = argc > 1 ? argv[1] : "all";
+    unsigned int iterations = argc > 2 ? (unsigned int)atoi(argv[2]) : 0;
+    int result = 0;
+    bool known = false;
+
+    if (!strcmp(suite, "all") || !strcmp(suite, "fsm"))
+    {
+        known = true;
+        result |= runFsmBenchmark(iterations ? iterations : 1000);
+    }
+    if (!strcmp(suite, "all") || !strcmp(suite, "dispatch"))
+    {
+        known = true;
+        result |= runDispatchBenchmark(iterations ? iterations : 10000000);
+    }
+    if (!strcmp(suite, "all") || !strcmp(suite, "publish"))
+    {
+        known = true;
+        result |= runPublishBenchmark(iterations ? iterations : 100000);
+    }
+
+    if (!strcmp(suite, "all") || !strcmp(suite, "wire"))
+    {
+        known = true;
+        result |= runWireBenchmark(iterations ? iterations : 100000);
+    }
+    if (!strcmp(suite, "all") || !strcmp(suite, "log"))
+    {
+        known = true;
+        result |= runLogBenchmark(iterations ? iterations : 1000000);
+    }
+    if (!strcmp(suite, "all") || !strcmp(suite, "scale"))
+    {
+        known = true;
+        result |= runScalingBenchmark(iterations ? iterations : 20);
+    }
+
+    if (!known)
+    {
+        printf("usage: %s [all|fsm|dispatch|publish|wire|log|scale] [iterations]\n", argv[0]);
+        return 2;
+    }
+    return result;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file BenchmarkStatistics.h
+ * @brief Sample collection and report helpers for the native benchmarks
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef BENCHMARKSTATISTICS_H__
+#define BENCHMARKSTATISTICS_H__
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+/**
+ * @brief Collects samples and prints min / mean / p50 / p99 / max
+ * 
+ */
+class BenchmarkSamples
+{
+    public:
+
+    /**
+     * @brief Add a sample
+     * 
+     * @param value 
+     */
+    void add(double value) { samples.push_back(value); }
+
+    /**
+     * @brief Number of samples
+     * 
+     * @return size_t 
+     */
+    size_t size() const { return samples.size(); }
+
+    /**
+     * @brief Sum of all samples
+     * 
+     * @return double 
+     */
+    double sum() const
+    {
+        double total = 0;
+        for (double value : samples)
+        {
+            total += value;
+        }
+        return total;
+    }
+
+    /**
+     * @brief Percentile of the samples
+     * 
+     * @param p - 0.5 for the median, 1.0 for the maximum
+     * @return double 
+     */
+    double percentile(double p) const
+    {
+        if (samples.empty())
+        {
+            return 0;
+        }
+        std::vector<double> sorted(samples);
+        std::sort(sorted.begin(), sorted.end());
+        return percentile(sorted, p);
+    }
+
+    /**
+     * @brief Print one report line
+     * 
+     * @param label - name of the measurement
+     * @param unit - unit of the samples
+     */
+    void print(const char *label, const char *unit) const
+    {
+        if (samples.empty())
+        {
+            printf("  %-28s no samples\n", label);
+            return;
+        }
+        std::vector<double> sorted(samples);
+        std::sort(sorted.begin(), sorted.end());
+        printf("  %-28s min %10.2f  mean %10.2f  p50 %10.2f  p99 %10.2f  max %10.2f %s\n",
+               label, sorted.front(), sum() / sorted.size(), percentile(sorted, 0.50),
+               percentile(sorted, 0.99), sorted.back(), unit);
+    }
+
+    private:
+    static double percentile(const std::vector<double> &sorted, double p)
+    {
+        size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    }
+
+    std::vector<double> samples;    ///< collected samples
+};
+
+/**
+ * @brief Host stopwatch in microseconds
+ * 
+ */
+class BenchmarkStopwatch
+{
+    public:
+    BenchmarkStopwatch() : start(std::chrono::steady_clock::now()) {}
+
+    /**
+     * @brief Elapsed host time since construction or last restart
+     * 
+     * @return double - microseconds
+     */
+    double elapsedMicros() const
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * @brief Restart the stopwatch
+     * 
+     */
+    void restart() { start = std::chrono::steady_clock::now(); }
+
+    private:
+    std::chrono::steady_clock::time_point start;    ///< start time
+};
+
+#endif // BENCHMARKSTATISTICS_H__
@@ -0,0 +1,242 @@
+/**
+ * @file DispatchBenchmark.cpp
+ * @brief Dispatch cost of the transition table engine against the former nested switch
+ * 
+ * SwitchFsm is the switch over State with if/else chains over Event and the
+ * do-action function pointer CommunicationCtrl used before the table engine
+ * (without its missing breaks). TableFsm runs the same transitions on
+ * StateMachine. Both call the same non-inlined actions, so only the dispatch differs.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "DispatchBenchmark.h"
+
+#include <stdio.h>
+#include <vector>
+
+#include "BenchmarkStatistics.h"
+#include "StateMachine.h"
+
+#define NOINLINE __attribute__((noinline))
+
+enum class State { idle, publish, boxCommunication, arrivConfirmation, bufferSimulation, errorState, resetState };
+enum class Event { NoEvent, Publish, SearchBox, BoxAvailable, ReqBox, AnswerReceived, NoAnswerReceived, SimulateBuffer, ArrivConfirmation, Error, Resume, Reset };
+
+static const size_t STATE_COUNT = (size_t)State::resetState + 1;
+static const size_t EVENT_COUNT = (size_t)Event::Reset + 1;
+
+/**
+ * @brief Empty actions shared by both implementations
+ * 
+ */
+class Actions
+{
+    public:
+    Actions(const std::vector<Event> &events) : events(events) {}
+
+    NOINLINE void entry() { entries++; }
+    NOINLINE void exit() { exits++; }
+    NOINLINE Event next()
+    {
+        Event e = events[position++];
+        if (position == events.size())
+        {
+            position = 0;
+        }
+        return e;
+    }
+
+    unsigned long entries = 0;      ///< number of entry actions
+    unsigned long exits = 0;        ///< number of exit actions
+
+    private:
+    const std::vector<Event> &events;
+    size_t position = 0;
+};
+
+/**
+ * @brief Former nested switch dispatch
+ * 
+ */
+class SwitchFsm : public Actions
+{
+    public:
+    SwitchFsm(const std::vector<Event> &events) : Actions(events) {}
+
+    void loop() { process((this->*doActionFPtr)()); }
+
+    private:
+    NOINLINE void entryAction(State state, Event (SwitchFsm::*doAction)())
+    {
+        lastState = currentState;
+        currentState = state;
+        doActionFPtr = doAction;
+        entry();
+    }
+    NOINLINE Event doAction_idle() { return next(); }
+    NOINLINE Event doAction_publish() { return next(); }
+    NOINLINE Event doAction_box() { return next(); }
+    NOINLINE Event doAction_arriv() { return next(); }
+    NOINLINE Event doAction_buffer() { return next(); }
+    NOINLINE Event doAction_error() { return next(); }
+    NOINLINE Event doAction_reset() { return next(); }
+
+    void process(Event e)
+    {
+        switch (currentState)
+        {
+        case State::idle:
+            if (Event::Publish == e) { exit(); entryAction(State::publish, &SwitchFsm::doAction_publish); }
+            else if (Event::SearchBox == e) { exit(); entryAction(State::boxCommunication, &SwitchFsm::doAction_box); }
+            else if (Event::ArrivConfirmation == e) { exit(); entryAction(State::arrivConfirmation, &SwitchFsm::doAction_arriv); }
+            else if (Event::Error == e) { exit(); entryAction(State::errorState, &SwitchFsm::doAction_error); }
+            break;
+        case State::publish:
+            if (Event::NoEvent == e) { exit(); entryAction(State::idle, &SwitchFsm::doAction_idle); }
+            else if (Event::Error == e) { exit(); entryAction(State::errorState, &SwitchFsm::doAction_error); }
+            break;
+        case State::boxCommunication:
+            if (Event::SimulateBuffer == e) { exit(); entryAction(State::bufferSimulation, &SwitchFsm::doAction_buffer); }
+            else if (Event::BoxAvailable == e || Event::ReqBox == e) { subEvent = e; }
+            else if (Event::AnswerReceived == e) { exit(); entryAction(State::idle, &SwitchFsm::doAction_idle); }
+            else if (Event::Error == e) { exit(); entryAction(State::errorState, &SwitchFsm::doAction_error); }
+            break;
+        case State::arrivConfirmation:
+            if (Event::AnswerReceived == e) { exit(); entryAction(State::idle, &SwitchFsm::doAction_idle); }
+            else if (Event::Error == e) { exit(); entryAction(State::errorState, &SwitchFsm::doAction_error); }
+            break;
+        case State::errorState:
+            if (Event::Resume == e)
+            {
+                exit();
+                switch (lastState)
+                {
+                case State::publish: entryAction(State::publish, &SwitchFsm::doAction_publish); break;
+                case State::boxCommunication: entryAction(State::boxCommunication, &SwitchFsm::doAction_box); break;
+                case State::arrivConfirmation: entryAction(State::arrivConfirmation, &SwitchFsm::doAction_arriv); break;
+                case State::bufferSimulation: entryAction(State::bufferSimulation, &SwitchFsm::doAction_buffer); break;
+                default: entryAction(State::idle, &SwitchFsm::doAction_idle); break;
+                }
+            }
+            else if (Event::Reset == e) { exit(); entryAction(State::resetState, &SwitchFsm::doAction_reset); }
+            break;
+        case State::resetState:
+            if (Event::Resume == e) { exit(); entryAction(State::idle, &SwitchFsm::doAction_idle); }
+            break;
+        case State::bufferSimulation:
+            if (Event::AnswerReceived == e) { exit(); entryAction(State::idle, &SwitchFsm::doAction_idle); }
+            else if (Event::Error == e) { exit(); entryAction(State::errorState, &SwitchFsm::doAction_error); }
+            break;
+        }
+    }
+
+    State currentState = State::idle;
+    State lastState = State::idle;
+    Event subEvent = Event::NoEvent;
+    Event (SwitchFsm::*doActionFPtr)() = &SwitchFsm::doAction_idle;
+};
+
+/**
+ * @brief Transition table dispatch
+ * 
+ */
+class TableFsm : public Actions
+{
+    public:
+    TableFsm(const std::vector<Event> &events) : Actions(events), fsm(this, transitions, states, State::idle, Event::NoEvent)
+    {
+        buildTables();
+    }
+
+    void loop() { fsm.process(fsm.doAction()); }
+
+    private:
+    NOINLINE void entryAction() { entry(); }
+    NOINLINE void exitAction() { exit(); }
+    NOINLINE Event doAction() { return next(); }
+
+    void set(State s, Event e, TransitionKind kind, State n)
+    {
+        transitions[(size_t)s][(size_t)e] = {s, e, kind, n};
+    }
+
+    void buildTables()
+    {
+        for (size_t s = 0; s < STATE_COUNT; s++)
+        {
+            states[s] = {(State)s, &TableFsm::entryAction, &TableFsm::doAction, &TableFsm::exitAction};
+            for (size_t e = 0; e < EVENT_COUNT; e++)
+            {
+                set((State)s, (Event)e, TransitionKind::Ignore, (State)s);
+            }
+        }
+        set(State::idle, Event::Publish, TransitionKind::External, State::publish);
+        set(State::idle, Event::SearchBox, TransitionKind::External, State::boxCommunication);
+        set(State::idle, Event::ArrivConfirmation, TransitionKind::External, State::arrivConfirmation);
+        set(State::idle, Event::Error, TransitionKind::External, State::errorState);
+        set(State::publish, Event::NoEvent, TransitionKind::External, State::idle);
+        set(State::publish, Event::Error, TransitionKind::External, State::errorState);
+        set(State::boxCommunication, Event::SimulateBuffer, TransitionKind::External, State::bufferSimulation);
+        set(State::boxCommunication, Event::BoxAvailable, TransitionKind::Internal, State::boxCommunication);
+        set(State::boxCommunication, Event::ReqBox, TransitionKind::Internal, State::boxCommunication);
+        set(State::boxCommunication, Event::AnswerReceived, TransitionKind::External, State::idle);
+        set(State::boxCommunication, Event::Error, TransitionKind::External, State::errorState);
+        set(State::arrivConfirmation, Event::AnswerReceived, TransitionKind::External, State::idle);
+        set(State::arrivConfirmation, Event::Error, TransitionKind::External, State::errorState);
+        set(State::errorState, Event::Resume, TransitionKind::History, State::errorState);
+        set(State::errorState, Event::Reset, TransitionKind::External, State::resetState);
+        set(State::resetState, Event::Resume, TransitionKind::External, State::idle);
+        set(State::bufferSimulation, Event::AnswerReceived, TransitionKind::External, State::idle);
+        set(State::bufferSimulation, Event::Error, TransitionKind::External, State::errorState);
+    }
+
+    Transition<State, Event> transitions[STATE_COUNT][EVENT_COUNT];
+    StateActions<TableFsm, State, Event> states[STATE_COUNT];
+    StateMachine<TableFsm, State, Event, STATE_COUNT, EVENT_COUNT> fsm;
+};
+
+template <typename Fsm>
+static void measure(const std::vector<Event> &events, unsigned int passes, BenchmarkSamples &samples, unsigned long &transitions)
+{
+    Fsm fsm(events);
+    BenchmarkStopwatch stopwatch;
+    for (unsigned int i = 0; i < passes; i++)
+    {
+        fsm.loop();
+    }
+    samples.add(stopwatch.elapsedMicros() * 1000.0 / passes);
+    transitions = fsm.entries;
+}
+
+int runDispatchBenchmark(unsigned int passes)
+{
+    // mostly NoEvent like a polling loop, every 8th pass a random event
+    std::vector<Event> events;
+    unsigned int seed = 12345;
+    for (unsigned int i = 0; i < 4096; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        events.push_back((i % 8) ? Event::NoEvent : (Event)((seed >> 16) % EVENT_COUNT));
+    }
+
+    BenchmarkSamples switchSamples;
+    BenchmarkSamples tableSamples;
+    unsigned long switchTransitions = 0;
+    unsigned long tableTransitions = 0;
+    for (int run = 0; run < 10; run++)
+    {
+        measure<SwitchFsm>(events, passes, switchSamples, switchTransitions);
+        measure<TableFsm>(events, passes, tableSamples, tableTransitions);
+    }
+
+    printf("FSM dispatch: %u loop passes x 10 runs\n", passes);
+    switchSamples.print("nested switch", "ns/pass");
+    tableSamples.print("transition table", "ns/pass");
+    printf("  transitions per run: switch %lu, table %lu\n", switchTransitions, tableTransitions);
+    return switchTransitions == tableTransitions ? 0 : 1;
+}
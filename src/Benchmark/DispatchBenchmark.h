@@ -0,0 +1,26 @@
+/**
+ * @file DispatchBenchmark.h
+ * @brief Dispatch cost of the transition table engine against the former nested switch
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef DISPATCHBENCHMARK_H__
+#define DISPATCHBENCHMARK_H__
+
+/**
+ * @brief Dispatches the same event stream through both FSM implementations
+ * 
+ * - both run the states and events of CommunicationCtrl with empty actions
+ * - reports ns per loop pass (do-action + process)
+ * 
+ * @param events - number of events
+ * @return int - 0 on success
+ */
+int runDispatchBenchmark(unsigned int events);
+
+#endif // DISPATCHBENCHMARK_H__
@@ -0,0 +1,395 @@
+/**
+ * @file FsmBenchmark.cpp
+ * @brief Throughput benchmark of the communication hub FSM on the native build
+ * 
+ * The hub runs on the simulated clock: every loop() advances it by the time
+ * loop() reports until work is due, at least LOOP_PERIOD_MS, and delay()
+ * advances it without sleeping. Host time therefore
+ * measures the cost of the hub code, hub time what the line would see.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "FsmBenchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Wire.h>
+
+#include "AllocationCounter.h"
+#include "BenchmarkStatistics.h"
+#include "CommunicationHub.h"
+#include "MessageCodec.h"
+#include "SmartFactorySimulation.h"
+
+#define LOOP_PERIOD_MS 1                ///< simulated duration of one loop() pass
+#define MAX_LOOPS_PER_PHASE 1000000     ///< abort a phase which does not finish
+
+/**
+ * @brief Measurements of one phase of the package cycle
+ * 
+ */
+struct Phase
+{
+    /**
+     * @brief Construct a new Phase object without measurements
+     * 
+     * @param name - name of the phase
+     * @param event - i2c event which starts the phase
+     */
+    Phase(const char *name, const char *event) : name(name), event(event), hostMicros(), hubMillis(), loops() {}
+
+    const char *name;               ///< name of the phase
+    const char *event;              ///< i2c event which starts the phase
+    BenchmarkSamples hostMicros;    ///< host time per phase
+    BenchmarkSamples hubMillis;     ///< hub time per phase
+    BenchmarkSamples loops;         ///< loop() passes per phase
+};
+
+/**
+ * @brief Run one phase until the simulation reports the event as handled
+ * 
+ */
+static bool runPhase(CommunicationHub &hub, SmartFactorySimulation &simulation, Phase &phase,
+                     double &hostMicros, double &hubMillis)
+{
+    simulation.requestEvent(phase.event);
+    unsigned long hubStart = millis();
+    unsigned long loops = 0;
+    BenchmarkStopwatch stopwatch;
+    while (true)
+    {
+        if (++loops > MAX_LOOPS_PER_PHASE)
+        {
+            printf("phase %s did not finish\n", phase.name);
+            return false;
+        }
+        unsigned long sleep = hub.loop();
+        if (simulation.eventHandled())
+        {
+            break;      // the sleep belongs to the next phase
+        }
+        simulation.run(millis());
+        // sleep like the main loop until the hub has work again
+#ifdef DUAL_CORE
+        Communication::awaitPolls(2);      // the mqtt task sends the queued requests and takes the answers
+#endif
+        NativeClock::advance(sleep > LOOP_PERIOD_MS ? sleep : LOOP_PERIOD_MS);
+    }
+    hostMicros = stopwatch.elapsedMicros();
+    hubMillis = millis() - hubStart;
+    phase.hostMicros.add(hostMicros);
+    phase.hubMillis.add(hubMillis);
+    phase.loops.add(loops);
+    return true;
+}
+
+/**
+ * @brief Run one package cycle outside the measurement
+ * 
+ */
+static bool runCycle(CommunicationHub &hub, SmartFactorySimulation &simulation, Phase *phases, size_t count,
+                     unsigned int packageId)
+{
+    simulation.setPackageId(packageId);
+    for (size_t i = 0; i < count; i++)
+    {
+        double hostMicros = 0;
+        double hubMillis = 0;
+        if (!runPhase(hub, simulation, phases[i], hostMicros, hubMillis))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Let the box index expire twice and check the retained announcement renews it
+ * 
+ * - the broker sends the retained available message again with the same id on every refresh
+ * 
+ * @return true - the boxes are indexed again after the second refresh
+ */
+static bool runRetainedCheck(CommunicationHub &hub, SmartFactorySimulation &simulation, Phase *phases, size_t count,
+                             unsigned int packageId)
+{
+    simulation.retained = true;
+    for (unsigned int round = 0; round < 2; round++)
+    {
+        NativeClock::advance(BOX_AVAILABLE_EXPIRY + TIME_BETWEEN_SUBSCRIBE);
+        if (!runCycle(hub, simulation, phases, count, packageId + round))
+        {
+            return false;
+        }
+    }
+    return hub.getBoxIndex().any(millis());
+}
+
+/**
+ * @brief Drop the mqtt connection and check the hub subscribes its topics again
+ * 
+ * - the client reconnects with a new session, only a subscribe of Box/+/available brings the boxes back
+ * - the hub notices the lost session when its probe is not echoed, within two MQTT_PROBE_INTERVAL
+ * 
+ * @return true - the boxes are indexed again and a package cycle finishes
+ */
+static bool runReconnectCheck(CommunicationHub &hub, SmartFactorySimulation &simulation, Phase *phases, size_t count,
+                              unsigned int packageId)
+{
+    Communication::dropConnections();
+    NativeClock::advance(BOX_AVAILABLE_EXPIRY + TIME_BETWEEN_SUBSCRIBE);
+    unsigned long start = millis();
+    while (!hub.getBoxIndex().any(millis()) && millis() - start < 2 * MQTT_PROBE_INTERVAL + TIME_BETWEEN_SUBSCRIBE)
+    {
+        unsigned long sleep = hub.loop();
+#ifdef DUAL_CORE
+        Communication::awaitPolls(2);      // the mqtt task sends the queued requests and takes the answers
+#endif
+        NativeClock::advance(sleep > LOOP_PERIOD_MS ? sleep : LOOP_PERIOD_MS);
+    }
+    return hub.getBoxIndex().any(millis()) && runCycle(hub, simulation, phases, count, packageId);
+}
+
+/**
+ * @brief Publish CBOR through a client which hands msg.c_str() on and so cuts text at the first zero byte
+ * 
+ * - the message id encodes with zero bytes, a payload cut there does not decode
+ * 
+ * @return true - the payload reached the broker whole
+ */
+static bool runBinaryPublishCheck(CommunicationHub &hub)
+{
+    SBToSOHandshakeMessage handshake;
+    handshake.setMessage(123458, Consignor::SO1, "SB1", "SB1", "cargo", "West", 2);
+    uint8_t expected[MESSAGE_CODEC_MAX_SIZE];
+    size_t length = MessageCodec::encode(handshake, expected);
+
+    String received;
+    Communication::cStringPayloads = true;
+    Communication::onPublish = [&received](Communication &, const String &, const String &msg) { received = msg; };
+    bool sent = hub.publishBinary("Sortic/SO1/handshake", handshake);
+#ifdef DUAL_CORE
+    Communication::awaitPolls(2);      // the mqtt task publishes the queued payload
+#endif
+    Communication::onPublish = nullptr;
+    Communication::cStringPayloads = false;
+    return sent && memchr(expected, 0, length) && received.length() == length && memcmp(expected, received.c_str(), length) == 0;
+}
+
+#ifdef HUB_METRICS
+/**
+ * @brief Get the length of the first CBOR item of a payload, covers the items of a metrics snapshot
+ * 
+ * @return size_t - length of the item, 0 if it is not complete
+ */
+static size_t cborItemLength(const uint8_t *payload, size_t length)
+{
+    if (length == 0)
+    {
+        return 0;
+    }
+    uint8_t major = payload[0] >> 5;
+    uint8_t info = payload[0] & 0x1F;
+    size_t size = 1;
+    unsigned long long argument = info;
+    if (info >= 24)
+    {
+        size_t bytes = info == 24 ? 1 : info == 25 ? 2 : info == 26 ? 4 : info == 27 ? 8 : 0;
+        if (bytes == 0 || length < 1 + bytes)
+        {
+            return 0;
+        }
+        argument = 0;
+        for (size_t i = 1; i <= bytes; i++)
+        {
+            argument = argument << 8 | payload[i];
+        }
+        size += bytes;
+    }
+    switch (major)
+    {
+    case 0:     // unsigned integer
+        return size;
+    case 3:     // text
+        return length - size >= argument ? size + (size_t)argument : 0;
+    case 4:     // array
+    case 6:     // tag, one item follows
+        for (unsigned long long i = 0; i < (major == 4 ? argument : 1); i++)
+        {
+            size_t item = cborItemLength(payload + size, length - size);
+            if (item == 0)
+            {
+                return 0;
+            }
+            size += item;
+        }
+        return size;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Wait for the metrics snapshot of the hub with a client which cuts text at the first zero byte
+ * 
+ * - the counters of the snapshot are 0 without DUAL_CORE, a snapshot cut there is incomplete CBOR
+ * 
+ * @return true - the snapshot reached the broker whole
+ */
+static bool runMetricsPublishCheck(CommunicationHub &hub)
+{
+    String received;
+    Communication::cStringPayloads = true;
+    Communication::onPublish = [&received](Communication &, const String &topic, const String &msg)
+    {
+        if (topic == "Sortic/" METRICS_HUB_OWNER "/metrics")
+        {
+            received = msg;
+        }
+    };
+    unsigned long start = millis();
+    while (received.length() == 0 && millis() - start <= 2 * METRICS_INTERVAL)
+    {
+        unsigned long sleep = hub.loop();
+#ifdef DUAL_CORE
+        Communication::awaitPolls(2);      // the mqtt task publishes the queued snapshot
+#endif
+        NativeClock::advance(sleep > LOOP_PERIOD_MS ? sleep : LOOP_PERIOD_MS);
+    }
+    Communication::onPublish = nullptr;
+    Communication::cStringPayloads = false;
+    const uint8_t *payload = (const uint8_t *)received.c_str();
+    return received.length() > 0 && cborItemLength(payload, received.length()) == received.length();
+}
+#endif
+
+#ifdef TRACE_LOG
+/**
+ * @brief Dump the TraceLog ring over mqtt and look for a record written just before
+ * 
+ * @return true - the record arrived on Sortic/hub/trace
+ */
+static bool runTracePublishCheck(CommunicationHub &hub)
+{
+    String received;
+    Communication::onPublish = [&received](Communication &, const String &topic, const String &msg)
+    {
+        if (topic == "Sortic/" TRACE_OWNER "/trace")
+        {
+            received += msg;
+        }
+    };
+    traceLog.record(TraceLevel::Status, "trace publish check ", 42L);
+    size_t published = hub.publishTrace();
+#ifdef DUAL_CORE
+    Communication::awaitPolls(2);      // the mqtt task publishes the queued payloads
+#endif
+    Communication::onPublish = nullptr;
+    return published > 0 && strstr(received.c_str(), "trace publish check 42\n") != nullptr;
+}
+#endif
+
+int runFsmBenchmark(unsigned int cycles)
+{
+    NativeClock::setSimulated(true);
+    Serial.enabled = getenv("BENCH_VERBOSE") != nullptr;
+
+    SmartFactorySimulation simulation({{Consignor::SB1, "SB1", "East", 1},
+                                       {Consignor::SB2, "SB2", "West", 2},
+                                       {Consignor::SB3, "SB3", "North", 3}});
+    simulation.retransmissions = 1;
+    simulation.attach();
+    Communication::reset();
+
+    CommunicationHub hub(1);
+    hub.getSortic(0).sortic.targetReg = "West";
+
+    Phase phases[] = {{"PublishPAC", "PublishPAC#"},
+                      {"BoxComm + handshake", "BoxComm####"},
+                      {"ArrivConf", "ArrivConf##"}};
+    BenchmarkSamples cycleMicros;
+    BenchmarkSamples cycleMillis;
+    unsigned long allocationsBefore = AllocationCounter::allocations();
+    unsigned long i2cReadsBefore = I2cCommunication::readCount + Wire.bytesRead / I2C_FRAME_SIZE;
+
+    for (unsigned int cycle = 0; cycle < cycles; cycle++)
+    {
+        simulation.setPackageId(cycle);
+        double cycleHost = 0;
+        double cycleHub = 0;
+        for (Phase &phase : phases)
+        {
+            double hostMicros = 0;
+            double hubMillis = 0;
+            if (!runPhase(hub, simulation, phase, hostMicros, hubMillis))
+            {
+                simulation.detach();
+                return 1;
+            }
+            cycleHost += hostMicros;
+            cycleHub += hubMillis;
+        }
+        cycleMicros.add(cycleHost);
+        cycleMillis.add(cycleHub);
+    }
+    unsigned long allocations = AllocationCounter::allocations() - allocationsBefore;
+
+    printf("FSM throughput: %u package cycles\n", cycles);
+    printf("  host: %.0f cycles/sec\n", cycles / (cycleMicros.sum() / 1e6));
+    printf("  hub:  %.3f cycles/sec (simulated time, at least %d ms per loop pass)\n",
+           cycles / (cycleMillis.sum() / 1e3), LOOP_PERIOD_MS);
+    printf("host time per phase:\n");
+    for (Phase &phase : phases)
+    {
+        phase.hostMicros.print(phase.name, "us");
+    }
+    cycleMicros.print("cycle", "us");
+    printf("hub time per phase:\n");
+    for (Phase &phase : phases)
+    {
+        phase.hubMillis.print(phase.name, "ms");
+    }
+    cycleMillis.print("cycle", "ms");
+    printf("loop() passes per phase:\n");
+    for (Phase &phase : phases)
+    {
+        phase.loops.print(phase.name, "");
+    }
+    printf("bus traffic per cycle: %.2f i2c reads, %.2f publish, %.2f subscribe, %.2f unsubscribe\n",
+           (double)(I2cCommunication::readCount + Wire.bytesRead / I2C_FRAME_SIZE - i2cReadsBefore) / cycles,
+           (double)Communication::publishCount / cycles,
+           (double)Communication::subscribeCount / cycles,
+           (double)Communication::unsubscribeCount / cycles);
+    printf("subscription requests saved per cycle: %.2f\n", (double)hub.getSavedSubscriptionRequests() / cycles);
+    printf("heap allocations per cycle: %.2f (hub and simulation)\n", (double)allocations / cycles);
+    printf("duplicated box messages dropped: %lu\n", hub.getDroppedDuplicates());
+    printf("mqtt task: %lu received messages dropped, %lu waits for the command queue\n",
+           hub.getDroppedInboxMessages(), hub.getMqttStalls());
+
+    size_t count = sizeof(phases) / sizeof(phases[0]);
+    bool renewed = runRetainedCheck(hub, simulation, phases, count, cycles);
+    printf("boxes indexed after a repeated retained announcement: %s\n", renewed ? "yes" : "no");
+    bool reconnected = renewed && runReconnectCheck(hub, simulation, phases, count, cycles + 2);
+    printf("package cycle after a dropped mqtt connection: %s\n", reconnected ? "yes" : "no");
+    simulation.detach();
+    bool whole = runBinaryPublishCheck(hub);
+    printf("CBOR payload whole through a client which cuts text at zero bytes: %s\n", whole ? "yes" : "no");
+#ifdef HUB_METRICS
+    bool metrics = runMetricsPublishCheck(hub);
+    printf("metrics snapshot whole through a client which cuts text at zero bytes: %s\n", metrics ? "yes" : "no");
+    whole = whole && metrics;
+#endif
+#ifdef TRACE_LOG
+    bool traced = runTracePublishCheck(hub);
+    printf("trace ring dumped on mqtt: %s\n", traced ? "yes" : "no");
+    whole = whole && traced;
+#endif
+    return reconnected && whole ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file FsmBenchmark.h
+ * @brief Throughput benchmark of the communication hub FSM on the native build
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef FSMBENCHMARK_H__
+#define FSMBENCHMARK_H__
+
+/**
+ * @brief Drives CommunicationHub::loop() with one sortic through full package cycles
+ * 
+ * - PublishPAC -> BoxComm -> handshake -> ArrivConf
+ * - reports cycles/sec and per-phase latency in host time and in hub time
+ * 
+ * @param cycles - number of package cycles
+ * @return int - 0 on success
+ */
+int runFsmBenchmark(unsigned int cycles);
+
+#endif // FSMBENCHMARK_H__
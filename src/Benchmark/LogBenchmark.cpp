@@ -0,0 +1,148 @@
+/**
+ * @file LogBenchmark.cpp
+ * @brief Benchmark of the TraceLog backend of the logging macros on the native build
+ * 
+ * The sites are the ones of CommunicationCtrl::process(): a function call, an
+ * event with its name and a status line. The serial time is computed from
+ * the formatted lines, 10 bits per character at 9600 baud, which is what
+ * Serial.println() blocks when its transmit buffer is full.
+ * 
+ * A second ring is written by another thread while it is drained, like the
+ * mqtt task of DUAL_CORE logs while the loop drains. Every record must come
+ * out whole or be counted as lost.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "LogBenchmark.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <thread>
+
+#include <Arduino.h>
+
+#include "AllocationCounter.h"
+#include "BenchmarkStatistics.h"
+#include "TraceLog.h"
+
+#define LOG_BENCHMARK_BAUD 9600     ///< baud rate of Serial in main.cpp
+
+static TraceLog<256> benchmarkLog;  ///< ring of the benchmark, independent of TRACE_LOG
+static TraceLog<16> concurrentLog;  ///< ring written by another thread, small so that it wraps while it is drained
+
+/**
+ * @brief Output of the drain which checks the records of concurrentLog
+ * 
+ */
+struct TraceCheck
+{
+    /**
+     * @brief Take one line, a record is "a=1" or "b=2", the other pairings are half written
+     * 
+     * @param line - formatted line
+     */
+    void print(const char *line)
+    {
+        if (strstr(line, "trace check "))
+        {
+            lines++;
+            torn += !strstr(line, "a=1\n") && !strstr(line, "b=2\n");
+        }
+    }
+
+    unsigned long lines = 0;        ///< records drained
+    unsigned long torn = 0;         ///< records with the argument of the other site
+};
+
+/**
+ * @brief Drain concurrentLog while another thread writes it
+ * 
+ * @param records - records the thread writes
+ * @return true - every record was printed whole or counted as lost
+ */
+static bool runConcurrentCheck(unsigned int records)
+{
+    TraceCheck check;
+    std::atomic<bool> writing{true};
+    std::thread writer([&writing, records]()
+    {
+        for (unsigned int i = 0; i < records; i++)
+        {
+            if (i & 1)
+            {
+                concurrentLog.record(TraceLevel::Info1, "trace check b=", 2);
+            }
+            else
+            {
+                concurrentLog.record(TraceLevel::Info1, "trace check a=", 1);
+            }
+            if ((i & 3) == 3)
+            {
+                std::this_thread::yield();      // let the drain catch up now and then
+            }
+        }
+        writing = false;
+    });
+    while (writing)
+    {
+        concurrentLog.drain(4, check);
+    }
+    writer.join();
+    while (concurrentLog.drain(16, check) > 0)
+    {
+    }
+    printf("  concurrent drain       %12lu records, %lu lost, %lu half written\n", check.lines, concurrentLog.getLost(), check.torn);
+    return check.torn == 0 && check.lines + concurrentLog.getLost() == records;
+}
+
+int runLogBenchmark(unsigned int records)
+{
+    static const char *const events[] = {"NoEvent", "Publish", "SearchBox", "AnswerReceived"};
+    static const unsigned int SITES_PER_ROUND = 255;   // fits the ring, nothing is lost
+    bool serialEnabled = Serial.enabled;
+    Serial.enabled = false;         // the drain formats, the output is dropped
+
+    unsigned int rounds = (records + SITES_PER_ROUND - 1) / SITES_PER_ROUND;
+    unsigned int recorded = rounds * SITES_PER_ROUND;
+    unsigned long allocationsBefore = AllocationCounter::allocations();
+    double recordMicros = 0;
+    double drainMicros = 0;
+    for (unsigned int round = 0; round < rounds; round++)
+    {
+        // fill the ring, then drain it like the hub does before it sleeps
+        BenchmarkStopwatch record;
+        for (unsigned int i = 0; i < SITES_PER_ROUND / 3; i++)
+        {
+            benchmarkLog.record(TraceLevel::FuncCall, "CommunicationCtrl::process(Event)");
+            benchmarkLog.record(TraceLevel::Event, "CommunicationCtrl ", events[i & 3]);
+            benchmarkLog.record(TraceLevel::Status, "Entering State: boxCommunication");
+        }
+        recordMicros += record.elapsedMicros();
+
+        BenchmarkStopwatch drain;
+        benchmarkLog.drain(SITES_PER_ROUND);
+        drainMicros += drain.elapsedMicros();
+    }
+    unsigned long allocations = AllocationCounter::allocations() - allocationsBefore;
+    Serial.enabled = serialEnabled;
+
+    // the same three lines printed with Serial.println(), 10 bits per character
+    size_t characters = strlen("CommunicationCtrl::process(Event)") + strlen("CommunicationCtrl SearchBox") +
+                        strlen("Entering State: boxCommunication") + 3 * 2;
+    double serialNanos = characters * 10 * 1e9 / LOG_BENCHMARK_BAUD / 3;
+
+    printf("Logging: %u records\n", recorded);
+    printf("  record (hot path)      %12.1f ns/record\n", recordMicros * 1e3 / recorded);
+    printf("  drain and format       %12.1f ns/record\n", drainMicros * 1e3 / recorded);
+    printf("  serial at %d baud    %12.1f ns/record\n", LOG_BENCHMARK_BAUD, serialNanos);
+    printf("  allocations            %12lu\n", allocations);
+    printf("  lost records           %12lu\n", benchmarkLog.getLost());
+    bool whole = runConcurrentCheck(records * 100);
+    return allocations == 0 && benchmarkLog.getLost() == 0 && whole ? 0 : 1;
+}
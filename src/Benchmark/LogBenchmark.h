@@ -0,0 +1,26 @@
+/**
+ * @file LogBenchmark.h
+ * @brief Benchmark of the TraceLog backend of the logging macros on the native build
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef LOGBENCHMARK_H__
+#define LOGBENCHMARK_H__
+
+/**
+ * @brief Records logging sites into a TraceLog and drains them
+ * 
+ * - reports ns per record on the hot path and per formatted record on the drain
+ * - compares with the time the same lines block a serial port of 9600 baud
+ * 
+ * @param records - number of recorded sites
+ * @return int - 0 on success
+ */
+int runLogBenchmark(unsigned int records);
+
+#endif // LOGBENCHMARK_H__
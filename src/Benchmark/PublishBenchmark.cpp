@@ -0,0 +1,195 @@
+/**
+ * @file PublishBenchmark.cpp
+ * @brief Heap allocations and cost of building the outgoing messages
+ * 
+ * Every variant fills the message the same way CommunicationCtrl does. The
+ * arguments are prepared outside the measurement. The build variants count
+ * only the message struct, the serialize variants add
+ * translateStructToString(), the publish variants the whole way into the mqtt
+ * client like CommunicationCtrl::publish() with a JSON topic. The JSON text
+ * is a new String of translateStructToString() on every publish, only the
+ * CBOR row, which fills the pooled handshake in place and streams it into
+ * the client like CommunicationHub::publishBinary(), publishes without
+ * allocating. Its cargo is longer than the small string buffer, so the
+ * host String keeps it on the heap like the Arduino String does.
+ * 
+ * The numbers are host numbers: String of the native build is a std::string
+ * with small string optimization, so short strings do not allocate. The
+ * Arduino String of the ESP32 allocates for every non-empty text, the
+ * serialized variants allocate more there.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "PublishBenchmark.h"
+
+#include <stdio.h>
+
+#include <Arduino.h>
+
+#include "AllocationCounter.h"
+#include "BenchmarkStatistics.h"
+#include "MessageCodec.h"
+#include "MessagePool.h"
+#include "MessageTranslation.h"
+#include "MQTTCommunication.h"
+
+static MessagePool<SOStateMessage> soStateMessagePool;              ///< pool of the state messages
+static MessagePool<PackageMessage> packageMessagePool;              ///< pool of the package messages
+static MessagePool<SBToSOHandshakeMessage> handshakeMessagePool;    ///< pool of the handshake messages
+
+static const String state = "waitForSort";          ///< argument of the state message
+static const String cargo = "cargo";                ///< argument of the package message
+static const String targetDest = "2";               ///< argument of the package message
+static const String targetReg = "West";             ///< argument of the package and handshake message
+static const String box = "SB1";                    ///< argument of the handshake message
+static const String longCargo = "cargo beyond the small string buffer";    ///< argument of the CBOR handshake, heap text on the host too
+
+static const String publishTopic = "Sortic/SO1/handshake";  ///< topic of the publish variants
+
+/**
+ * @brief Enum class holds how far a round takes the messages
+ * 
+ */
+enum class PublishStage
+{
+    Build,              ///< fill the message struct
+    Serialize,          ///< Build and translateStructToString()
+    Publish             ///< Serialize and hand the text to the mqtt client
+};
+
+static unsigned long long idCounter = 0;            ///< message id
+static size_t serializedLength = 0;                 ///< keeps the serialization from being optimized away
+
+/**
+ * @brief Build the messages of one publish round
+ * 
+ * @param pooled - take the messages from the pools instead of allocating them
+ * @param stage - how far the messages are taken
+ * @param client - mqtt client of PublishStage::Publish
+ */
+static void publishRound(bool pooled, PublishStage stage, Communication &client)
+{
+    std::shared_ptr<SOStateMessage> stateMessage = pooled ? soStateMessagePool.acquire() : std::shared_ptr<SOStateMessage>(new SOStateMessage());
+    stateMessage->setMessage(idCounter++, Consignor::SO1, state);
+    std::shared_ptr<PackageMessage> packageMessage = pooled ? packageMessagePool.acquire() : std::shared_ptr<PackageMessage>(new PackageMessage());
+    packageMessage->setMessage(idCounter++, Consignor::SO1, 42, cargo, targetDest, targetReg);
+    std::shared_ptr<SBToSOHandshakeMessage> handshakeMessage = pooled ? handshakeMessagePool.acquire() : std::shared_ptr<SBToSOHandshakeMessage>(new SBToSOHandshakeMessage());
+    handshakeMessage->setMessage(idCounter++, Consignor::SO1, box, box, cargo, targetReg, 1);
+    if (stage == PublishStage::Serialize)
+    {
+        serializedLength += Message::translateStructToString(stateMessage).length();
+        serializedLength += Message::translateStructToString(packageMessage).length();
+        serializedLength += Message::translateStructToString(handshakeMessage).length();
+    }
+    else if (stage == PublishStage::Publish)
+    {
+        client.publishMessage(publishTopic, Message::translateStructToString(stateMessage));
+        client.publishMessage(publishTopic, Message::translateStructToString(packageMessage));
+        client.publishMessage(publishTopic, Message::translateStructToString(handshakeMessage));
+    }
+}
+
+/**
+ * @brief Measure one variant
+ * 
+ * @param name - printed name
+ * @param pooled - use the pools
+ * @param stage - how far the messages are taken
+ * @param rounds - number of rounds
+ * @return unsigned long - allocations of all rounds after the first one
+ */
+static unsigned long measure(const char *name, bool pooled, PublishStage stage, unsigned int rounds)
+{
+    Communication client("publish", nullptr);
+    publishRound(pooled, stage, client);    // warm up, the pools may allocate here
+
+    unsigned long allocationsBefore = AllocationCounter::allocations();
+    BenchmarkStopwatch stopwatch;
+    for (unsigned int i = 0; i < rounds; i++)
+    {
+        publishRound(pooled, stage, client);
+    }
+    double nanos = stopwatch.elapsedMicros() * 1e3;
+    unsigned long allocations = AllocationCounter::allocations() - allocationsBefore;
+
+    printf("  %-28s %8.1f ns/message %8.2f allocations/message\n",
+           name, nanos / (3.0 * rounds), allocations / (3.0 * rounds));
+    return allocations;
+}
+
+/**
+ * @brief Stream a pooled handshake as CBOR into the mqtt client, the way publishBinary() sends it
+ * 
+ * @param client - mqtt client
+ */
+static void publishBinary(Communication &client)
+{
+    std::shared_ptr<SBToSOHandshakeMessage> handshakeMessage = handshakeMessagePool.acquire();
+    handshakeMessage->msgId = idCounter++;         // assigned in place, the Strings keep the capacity of the slot
+    handshakeMessage->msgConsignor = Consignor::SO1;
+    handshakeMessage->req = box;
+    handshakeMessage->ack = box;
+    handshakeMessage->cargo = longCargo;
+    handshakeMessage->targetReg = targetReg;
+    handshakeMessage->line = 1;
+    client.beginPublish(publishTopic, MessageCodec::encodedLength(*handshakeMessage));
+    serializedLength += MessageCodec::encode(*handshakeMessage, client);
+    client.endPublish();
+}
+
+/**
+ * @brief Measure the pooled handshake streamed as CBOR
+ * 
+ * @param rounds - number of publishes
+ * @return unsigned long - allocations of all publishes after the first one
+ */
+static unsigned long measureBinary(unsigned int rounds)
+{
+    Communication client("publish", nullptr);
+    publishBinary(client);              // warm up the pool and the client
+
+    unsigned long allocationsBefore = AllocationCounter::allocations();
+    BenchmarkStopwatch stopwatch;
+    for (unsigned int i = 0; i < rounds; i++)
+    {
+        publishBinary(client);
+    }
+    double nanos = stopwatch.elapsedMicros() * 1e3;
+    unsigned long allocations = AllocationCounter::allocations() - allocationsBefore;
+
+    printf("  %-28s %8.1f ns/message %8.2f allocations/message\n",
+           "pool + cbor, handshake", nanos / rounds, (double)allocations / rounds);
+    return allocations;
+}
+
+int runPublishBenchmark(unsigned int publishes)
+{
+    printf("Outgoing messages: %u per type (state, package, handshake), host String (std::string with small string optimization)\n", publishes);
+    measure("new, build only", false, PublishStage::Build, publishes);
+    unsigned long pooledAllocations = measure("pool, build only", true, PublishStage::Build, publishes);
+    measure("new + serialize", false, PublishStage::Serialize, publishes);
+    measure("pool + serialize", true, PublishStage::Serialize, publishes);
+    measure("new + publish", false, PublishStage::Publish, publishes);
+    measure("pool + publish", true, PublishStage::Publish, publishes);
+    unsigned long binaryAllocations = measureBinary(publishes);
+    printf("  pool misses: %lu, serialized bytes: %lu\n",
+           soStateMessagePool.getMisses() + packageMessagePool.getMisses() + handshakeMessagePool.getMisses(),
+           (unsigned long)serializedLength);
+
+    if (pooledAllocations != 0)
+    {
+        printf("pooled messages allocated %lu times in steady state before serialization\n", pooledAllocations);
+        return 1;
+    }
+    if (binaryAllocations != 0)
+    {
+        printf("pooled handshakes allocated %lu times in steady state when streamed as CBOR\n", binaryAllocations);
+        return 1;
+    }
+    return 0;
+}
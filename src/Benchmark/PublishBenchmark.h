@@ -0,0 +1,26 @@
+/**
+ * @file PublishBenchmark.h
+ * @brief Heap allocations and cost of building the outgoing messages
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef PUBLISHBENCHMARK_H__
+#define PUBLISHBENCHMARK_H__
+
+/**
+ * @brief Builds the messages the hub publishes with new and with MessagePool
+ * 
+ * - reports allocations and ns per message, with and without serialization
+ * - fails if a pooled message allocates after the first round
+ * 
+ * @param publishes - number of messages per type and variant
+ * @return int - 0 on success
+ */
+int runPublishBenchmark(unsigned int publishes);
+
+#endif // PUBLISHBENCHMARK_H__
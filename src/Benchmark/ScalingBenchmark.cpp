@@ -0,0 +1,151 @@
+/**
+ * @file ScalingBenchmark.cpp
+ * @brief Scaling benchmark of the communication hub with several sortics on the native build
+ * 
+ * All sortics of the hub run package cycles at the same time, each against
+ * its own simulated roboter. The boxes announce themselves periodically,
+ * because a sortic which joins a shared subscription gets no answer to it.
+ * The hub runs on the simulated clock like in the fsm suite, host time per
+ * loop() pass is the latency budget the main loop has to keep.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "ScalingBenchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "AllocationCounter.h"
+#include "BenchmarkStatistics.h"
+#include "CommunicationHub.h"
+#include "SmartFactorySimulation.h"
+
+#define SCALING_LOOP_BUDGET_US 1000     ///< host time one loop() pass may take, MQTT_POLL_INTERVAL_BUSY
+#define SCALING_ANNOUNCE_PERIOD 100     ///< time between the announcements of the boxes
+#define LOOP_PERIOD_MS 1                ///< simulated duration of one loop() pass
+#define MAX_LOOPS 10000000              ///< abort a run which does not finish
+
+/**
+ * @brief State of one simulated sortic in the benchmark
+ * 
+ */
+struct SorticRun
+{
+    size_t phase = 0;               ///< index of the requested event
+    unsigned int cycles = 0;        ///< finished package cycles
+};
+
+/**
+ * @brief Run the package cycles of a number of sortics
+ * 
+ * @return true - the p99 loop time is inside the budget
+ */
+static bool runSortics(size_t sortics, unsigned int cycles, bool &failed)
+{
+    static const char *const events[] = {"PublishPAC#", "BoxComm####", "ArrivConf##"};
+    static const char *const regions[] = {"East", "West", "North"};
+
+    SmartFactorySimulation simulation({{Consignor::SB1, "SB1", "East", 1},
+                                       {Consignor::SB2, "SB2", "West", 2},
+                                       {Consignor::SB3, "SB3", "North", 3}},
+                                      sortics);
+    simulation.retransmissions = 1;
+    simulation.announcePeriod = SCALING_ANNOUNCE_PERIOD;
+    simulation.attach();
+    Communication::reset();
+
+    CommunicationHub hub(sortics);
+    std::vector<SorticRun> runs(sortics);
+    for (size_t i = 0; i < sortics; i++)
+    {
+        hub.getSortic(i).sortic.targetReg = regions[i % 3];
+        simulation.setPackageId(0, i);
+        simulation.requestEvent(events[0], i);
+    }
+
+    BenchmarkSamples loopMicros;
+    BenchmarkStopwatch total;
+    unsigned long hubStart = millis();
+    unsigned long allocationsBefore = AllocationCounter::allocations();
+    size_t finished = 0;
+    unsigned long loops = 0;
+    while (finished < sortics)
+    {
+        if (++loops > MAX_LOOPS)
+        {
+            printf("%zu sortics did not finish\n", sortics);
+            failed = true;
+            break;
+        }
+        BenchmarkStopwatch stopwatch;
+        unsigned long sleep = hub.loop();
+        loopMicros.add(stopwatch.elapsedMicros());
+
+        for (size_t i = 0; i < sortics; i++)
+        {
+            SorticRun &run = runs[i];
+            if (run.cycles == cycles || !simulation.eventHandled(i))
+            {
+                continue;
+            }
+            if (++run.phase == 3)
+            {
+                run.phase = 0;
+                if (++run.cycles == cycles)
+                {
+                    finished++;
+                    continue;
+                }
+                simulation.setPackageId(run.cycles, i);
+            }
+            simulation.requestEvent(events[run.phase], i);
+            sleep = 0;      // the roboter reports the next event right away
+        }
+        simulation.run(millis());
+#ifdef DUAL_CORE
+        Communication::awaitPolls(2);      // the mqtt task sends the queued requests and takes the answers
+#endif
+        NativeClock::advance(sleep > LOOP_PERIOD_MS ? sleep : LOOP_PERIOD_MS);
+    }
+    double hostSeconds = total.elapsedMicros() / 1e6;
+    double hubSeconds = (millis() - hubStart) / 1e3;
+    unsigned long allocations = AllocationCounter::allocations() - allocationsBefore;
+    simulation.detach();
+    if (simulation.getMisdelivered() > 0)
+    {
+        printf("%zu sortics: %lu arrivals confirmed to a sortic whose package was not reported\n", sortics, simulation.getMisdelivered());
+        failed = true;
+    }
+
+    double p99 = loopMicros.percentile(0.99);
+    printf("%8zu %10.2f %10.2f %10.2f %12.0f %12.2f %10lu %12.2f\n", sortics, loopMicros.percentile(0.50), p99,
+           loopMicros.percentile(1.0), sortics * cycles / hostSeconds, sortics * cycles / hubSeconds, loops,
+           (double)allocations / (sortics * cycles));
+    return p99 <= SCALING_LOOP_BUDGET_US;
+}
+
+int runScalingBenchmark(unsigned int cycles)
+{
+    NativeClock::setSimulated(true);
+    Serial.enabled = getenv("BENCH_VERBOSE") != nullptr;
+
+    printf("Scaling: %u package cycles per sortic, loop budget %d us\n", cycles, SCALING_LOOP_BUDGET_US);
+    printf("%8s %10s %10s %10s %12s %12s %10s %12s\n", "sortics", "loop p50", "loop p99", "loop max",
+           "host cyc/s", "hub cyc/s", "loops", "allocs/cyc");
+    bool failed = false;
+    size_t withinBudget = 0;
+    for (size_t sortics = 1; sortics <= SORTIC_COUNT && !failed; sortics *= 2)
+    {
+        if (runSortics(sortics, cycles, failed))
+        {
+            withinBudget = sortics;
+        }
+    }
+    printf("sortics within the loop budget: %zu (SORTIC_COUNT %d)\n", withinBudget, SORTIC_COUNT);
+    return failed ? 1 : 0;
+}
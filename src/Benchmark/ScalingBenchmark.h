@@ -0,0 +1,27 @@
+/**
+ * @file ScalingBenchmark.h
+ * @brief Scaling benchmark of the communication hub with several sortics on the native build
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef SCALINGBENCHMARK_H__
+#define SCALINGBENCHMARK_H__
+
+/**
+ * @brief Drives CommunicationHub::loop() with 1, 2, 4 ... SORTIC_COUNT sortics
+ * 
+ * - every sortic runs package cycles PublishPAC -> BoxComm -> handshake -> ArrivConf on its own
+ * - reports the host time of one loop() pass against SCALING_LOOP_BUDGET_US
+ *   and the throughput in host time and hub time
+ * 
+ * @param cycles - number of package cycles of every sortic
+ * @return int - 0 on success
+ */
+int runScalingBenchmark(unsigned int cycles);
+
+#endif // SCALINGBENCHMARK_H__
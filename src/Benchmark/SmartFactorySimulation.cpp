@@ -0,0 +1,332 @@
+/**
+ * @file SmartFactorySimulation.cpp
+ * @brief Simulated Sortic roboter and smart boxes for the native build
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "SmartFactorySimulation.h"
+
+#include <memory>
+#include <stdlib.h>
+#include <Wire.h>
+
+#include "I2cFrame.h"
+#include "MainConfiguration.h"
+#include "MessageCodec.h"
+
+SmartFactorySimulation::SmartFactorySimulation(const std::vector<Box> &boxes, size_t roboters)
+    : boxes(boxes), roboters(roboters), lastReport(boxes.size(), 0)
+{
+}
+
+void SmartFactorySimulation::attach()
+{
+    I2cCommunication::onRead = [this](int address, ReceivedI2cMessage &message) { onRead(address, message); };
+    I2cCommunication::onWrite = [this](int address, const WriteI2cMessage &message) { onWrite(address, message); };
+    Wire.onRequest = [this](uint8_t address, uint8_t *buffer, size_t quantity) { return onRequestFrame(address, buffer, quantity); };
+    Wire.onReceive = [this](uint8_t address, const uint8_t *buffer, size_t length) { onReceiveFrame(address, buffer, length); };
+    Communication::onPublish = [this](Communication &, const String &topic, const String &msg) { onPublish(topic, msg); };
+    Communication::onSubscribe = [this](Communication &, const String &topic) { onSubscribe(topic); };
+}
+
+void SmartFactorySimulation::detach()
+{
+    I2cCommunication::onRead = nullptr;
+    I2cCommunication::onWrite = nullptr;
+    Wire.onRequest = nullptr;
+    Wire.onReceive = nullptr;
+    Communication::onPublish = nullptr;
+    Communication::onSubscribe = nullptr;
+}
+
+void SmartFactorySimulation::requestEvent(const char *newEvent, size_t roboter)
+{
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    Roboter &slave = roboters[roboter];
+    strncpy(slave.event, newEvent, sizeof(slave.event) - 1);
+    slave.pending = true;
+
+    // the acknowledge belongs to the package, a pipelined hub may get it before BoxComm####
+    if (!strcmp(newEvent, "PublishPAC#"))
+    {
+        slave.handshakeAcknowledged = false;
+    }
+}
+
+void SmartFactorySimulation::setPackageId(unsigned int packageId, size_t roboter)
+{
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    roboters[roboter].packageId = packageId;
+}
+
+bool SmartFactorySimulation::eventHandled(size_t roboter) const
+{
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    return !roboters[roboter].pending;
+}
+
+void SmartFactorySimulation::run(unsigned long now)
+{
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    for (std::deque<PendingState>::iterator pending = pendingStates.begin(); pending != pendingStates.end();)
+    {
+        if (pending->armed && (long)(now - pending->due) >= 0)
+        {
+            roboters[pending->roboter].packagesInBox++;
+            sendState(*pending->box);
+            pending = pendingStates.erase(pending);
+        }
+        else
+        {
+            pending++;
+        }
+    }
+    if (announcePeriod > 0 && now - lastAnnouncement >= announcePeriod)
+    {
+        lastAnnouncement = now;
+        announceBoxes();
+    }
+}
+
+unsigned long SmartFactorySimulation::getMisdelivered() const
+{
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    return misdelivered;
+}
+
+void SmartFactorySimulation::onRead(int slaveAddress, ReceivedI2cMessage &message)
+{
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    message = ReceivedI2cMessage();
+    Roboter *slave = findRoboter(slaveAddress);
+    if (slave && slave->pending)
+    {
+        strcpy(message.event, slave->event);
+        message.packageId = slave->packageId;
+        if (!strcmp(slave->event, "ArrivConf##"))
+        {
+            // the hub subscribes the state of the box now, the box reports the package once it is there
+            size_t roboter = (size_t)(slave - &roboters[0]);
+            for (PendingState &pending : pendingStates)
+            {
+                if (pending.roboter == roboter && !pending.armed)
+                {
+                    unsigned long &last = lastReport[(size_t)(pending.box - &boxes[0])];
+                    unsigned long due = millis() + (roboter + 1) * stateDelay;
+                    pending.armed = true;
+                    pending.due = (long)(due - last) > 0 ? due : last + 1;
+                    last = pending.due;
+                }
+            }
+        }
+    }
+}
+
+void SmartFactorySimulation::onWrite(int slaveAddress, const WriteI2cMessage &message)
+{
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    Roboter *slave = findRoboter(slaveAddress);
+    if (!slave)
+    {
+        return;
+    }
+    // the hub may write SortPackage before the handshake is done, the roboter waits for the box
+    if (!strcmp(slave->event, "BoxComm####") && !strcmp(message.event, "SortPackage") && slave->handshakeAcknowledged)
+    {
+        if (slave->pending && slave->box)
+        {
+            // the box receives the package and reports it
+            pendingStates.push_back({slave->box, (size_t)(slave - &roboters[0]), 0, false});
+        }
+        slave->pending = false;
+    }
+    if (!strcmp(message.event, "PackageArri"))
+    {
+        if (++slave->arrivalsConfirmed > slave->packagesInBox)
+        {
+            misdelivered++;
+        }
+        if (!strcmp(slave->event, "ArrivConf##"))
+        {
+            slave->pending = false;
+        }
+    }
+}
+
+size_t SmartFactorySimulation::onRequestFrame(uint8_t slaveAddress, uint8_t *buffer, size_t quantity)
+{
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    if (quantity < I2C_FRAME_SIZE)
+    {
+        return 0;
+    }
+    ReceivedI2cMessage message;
+    onRead(slaveAddress, message);
+    I2cFrame frame;
+    frame.opcode = I2cFrame::decodeLegacyEvent(message.event);
+    frame.state = message.state;
+    frame.position = message.position;
+    frame.packageId = (uint16_t)message.packageId;
+    frame.targetDest = message.targetDest;
+    frame.error = message.error;
+    frame.token = message.token;
+    I2cFrame::encode(frame, buffer);
+    return I2C_FRAME_SIZE;
+}
+
+void SmartFactorySimulation::onReceiveFrame(uint8_t slaveAddress, const uint8_t *buffer, size_t length)
+{
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    I2cFrame frame;
+    if (length != I2C_FRAME_SIZE || !I2cFrame::decode(buffer, frame))
+    {
+        return;
+    }
+    WriteI2cMessage message;
+    strcpy(message.event, I2cFrame::encodeLegacyEvent(frame.opcode));
+    message.targetLine = frame.targetLine;
+    onWrite(slaveAddress, message);
+}
+
+void SmartFactorySimulation::onPublish(const String &topic, const String &msg)
+{
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    String consignor;
+    Roboter *slave = findRoboter(topic, "/package", consignor);
+    if (slave)
+    {
+        if (!strcmp(slave->event, "PublishPAC#"))
+        {
+            slave->pending = false;
+        }
+        return;
+    }
+    slave = findRoboter(topic, "/handshake", consignor);
+    if (!slave)
+    {
+        return;
+    }
+
+    // answer the handshake as the requested box
+    String payload = msg;
+    std::shared_ptr<Message> request = MessageCodec::isBinary((const uint8_t *)payload.c_str(), payload.length())
+                                           ? MessageCodec::decode((const uint8_t *)payload.c_str(), payload.length())
+                                           : Message::translateJsonToStruct(&payload[0], payload.length());
+    if (!request || request->msgType != (int)Message::MessageType::SBToSOHandshake)
+    {
+        return;
+    }
+    std::shared_ptr<SBToSOHandshakeMessage> handshake = std::static_pointer_cast<SBToSOHandshakeMessage>(request);
+    const Box *box = findBox(handshake->req);
+    if (!box || handshake->ack.equals(HANDSHAKE_RELEASE))
+    {
+        return;     // a released box does not answer
+    }
+    std::shared_ptr<SBToSOHandshakeMessage> answer(new SBToSOHandshakeMessage());
+    if (handshake->ack.equals(box->name))
+    {
+        answer->setMessage(msgId++, box->consignor, box->name, consignor, handshake->cargo, handshake->targetReg, handshake->line);
+        slave->handshakeAcknowledged = true;
+        slave->box = box;
+    }
+    else
+    {
+        answer->setMessage(msgId++, box->consignor, consignor);
+    }
+    send("Box/" + box->name + "/handshake", answer);
+}
+
+void SmartFactorySimulation::onSubscribe(const String &topic)
+{
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    if (topic.equals("Box/+/available"))
+    {
+        announceBoxes();
+    }
+}
+
+SmartFactorySimulation::Roboter *SmartFactorySimulation::findRoboter(int slaveAddress)
+{
+    size_t index = (size_t)(slaveAddress - I2CSLAVEADDRUNO);
+    return slaveAddress >= I2CSLAVEADDRUNO && index < roboters.size() ? &roboters[index] : nullptr;
+}
+
+SmartFactorySimulation::Roboter *SmartFactorySimulation::findRoboter(const String &topic, const char *suffix, String &consignor)
+{
+    // Sortic/SO<n>/<suffix>
+    static const char prefix[] = "Sortic/" SORTIC_ID_PREFIX;
+    const char *name = topic.c_str();
+    if (strncmp(name, prefix, sizeof(prefix) - 1))
+    {
+        return nullptr;
+    }
+    char *end = nullptr;
+    unsigned long number = strtoul(name + sizeof(prefix) - 1, &end, 10);
+    if (number == 0 || number > roboters.size() || strcmp(end, suffix))
+    {
+        return nullptr;
+    }
+    consignor = SORTIC_ID_PREFIX + String((unsigned int)number);
+    return &roboters[number - 1];
+}
+
+const SmartFactorySimulation::Box *SmartFactorySimulation::findBox(const String &name) const
+{
+    for (const Box &box : boxes)
+    {
+        if (box.name.equals(name))
+        {
+            return &box;
+        }
+    }
+    return nullptr;
+}
+
+void SmartFactorySimulation::announceBoxes()
+{
+    // every box announces itself
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+        const Box &box = boxes[i];
+        std::shared_ptr<SBAvailableMessage> available(new SBAvailableMessage());
+        available->msgId = retained ? i : msgId++;
+        available->msgConsignor = box.consignor;
+        available->targetReg = box.targetReg;
+        available->line = box.line;
+        send("Box/" + box.name + "/available", available);
+    }
+}
+
+void SmartFactorySimulation::sendState(const Box &box)
+{
+    // the box reports a received package, the message does not say whose package it was
+    std::shared_ptr<SBStateMessage> state(new SBStateMessage());
+    state->msgId = msgId++;
+    state->msgConsignor = box.consignor;
+    state->state = "RetreivedPackage";
+    send("Box/" + box.name + "/state", state);
+}
+
+void SmartFactorySimulation::send(const String &topic, const std::shared_ptr<Message> &message)
+{
+    String payload;
+    uint8_t buffer[MESSAGE_CODEC_MAX_SIZE];
+    size_t length = binary ? MessageCodec::encode(*message, buffer) : 0;
+    if (length > 0)
+    {
+        payload.concat((const char *)buffer, (unsigned int)length);
+    }
+    else
+    {
+        payload = Message::translateStructToString(message);
+    }
+    for (unsigned int i = 0; i <= retransmissions; i++)
+    {
+        Communication::deliver(topic, payload);
+    }
+}
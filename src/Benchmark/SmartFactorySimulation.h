@@ -0,0 +1,181 @@
+/**
+ * @file SmartFactorySimulation.h
+ * @brief Simulated Sortic roboter and smart boxes for the native build
+ * 
+ * The simulation plays the i2c slaves (Sortic roboters) and the smart boxes on
+ * the in-process mqtt broker, so the communication hub can be driven through
+ * complete package cycles on the host. Roboter n answers on the i2c address
+ * I2CSLAVEADDRUNO + n and uses the topics of SO<n+1>. The roboter answers the string protocol
+ * of I2cCommunication as well as I2cFrame on Wire.
+ * 
+ * A box reports RetreivedPackage once for every package it receives, once
+ * the hub read the ArrivConf## of the roboter which sorted it and so has
+ * subscribed the state of the box. Roboter n needs (n + 1) * stateDelay to
+ * bring a package to the box, a box reports its packages in the order the
+ * hub read their ArrivConf##. The simulation counts PackageArrived writes to
+ * a roboter whose package no box reported yet as misdelivered.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef SMARTFACTORYSIMULATION_H__
+#define SMARTFACTORYSIMULATION_H__
+
+#include <Arduino.h>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "I2cCommunication.h"
+#include "MQTTCommunication.h"
+#include "MessageTranslation.h"
+
+/**
+ * @brief Simulated Sortic roboter and smart boxes
+ * 
+ */
+class SmartFactorySimulation
+{
+    public:
+
+    /**
+     * @brief Simulated smart box
+     * 
+     */
+    struct Box
+    {
+        Consignor consignor;        ///< consignor of the box
+        String name;                ///< name of the box, e.g. "SB1"
+        String targetReg;           ///< region the box accepts
+        int line;                   ///< line the box is placed on
+    };
+
+    /**
+     * @brief Construct a new Smart Factory Simulation object
+     * 
+     * @param boxes - boxes on the gametable
+     * @param roboters - number of sortic roboters
+     */
+    SmartFactorySimulation(const std::vector<Box> &boxes, size_t roboters = 1);
+
+    /**
+     * @brief Install the simulation on the i2c bus and the mqtt broker
+     * 
+     */
+    void attach();
+
+    /**
+     * @brief Remove the simulation from the i2c bus and the mqtt broker
+     * 
+     */
+    void detach();
+
+    /**
+     * @brief Let a roboter report an i2c event until the hub handled it
+     * 
+     * @param event - i2c event, e.g. "PublishPAC#"
+     * @param roboter - number of the roboter
+     */
+    void requestEvent(const char *event, size_t roboter = 0);
+
+    /**
+     * @brief Set the package id a roboter reports
+     * 
+     * @param packageId - package id
+     * @param roboter - number of the roboter
+     */
+    void setPackageId(unsigned int packageId, size_t roboter = 0);
+
+    /**
+     * @brief Let the boxes report the packages they received, and announce themselves if announcePeriod elapsed
+     * 
+     * - the hub subscribes a topic shared by several sortics only once at the broker,
+     *   the sortics which join later wait for the next announcement
+     * 
+     * @param now - current time
+     */
+    void run(unsigned long now);
+
+    /**
+     * @brief Get the number of PackageArrived writes to a roboter before a box reported its package
+     * 
+     * @return unsigned long - 0 if every arrival reached the roboter of the package
+     */
+    unsigned long getMisdelivered() const;
+
+    /**
+     * @brief Check whether the requested event was handled by the hub
+     * 
+     * - PublishPAC# is handled when the package is published
+     * - BoxComm#### is handled when the hub writes SortPackage after the box acknowledged
+     * - ArrivConf## is handled when the hub writes PackageArri
+     * 
+     * @param roboter - number of the roboter
+     * @return true 
+     * @return false 
+     */
+    bool eventHandled(size_t roboter = 0) const;
+
+    unsigned int retransmissions = 0;   ///< number of times every box message is sent again with the same id
+    unsigned long announcePeriod = 0;   ///< time between the announcements of the boxes, 0 only announces on a subscribe
+    bool binary = false;                ///< the boxes send CBOR instead of JSON
+    bool retained = false;              ///< the boxes announce with a fixed id, like a retained message the broker sends again
+    unsigned long stateDelay = 1;       ///< time the first roboter needs to bring a package to the box, every further roboter needs this much longer
+
+    private:
+
+    /**
+     * @brief Simulated Sortic roboter
+     * 
+     */
+    struct Roboter
+    {
+        char event[12] = "null#######";     ///< requested i2c event
+        bool pending = false;               ///< requested event not yet handled
+        bool handshakeAcknowledged = false; ///< a box acknowledged the handshake for the current package
+        unsigned int packageId = 0;         ///< package id reported by the roboter
+        const Box *box = nullptr;           ///< box which acknowledged the handshake for the current package
+        unsigned int packagesInBox = 0;     ///< packages of the roboter the boxes reported as received
+        unsigned int arrivalsConfirmed = 0; ///< PackageArrived writes to the roboter
+    };
+
+    /**
+     * @brief Package a box reports after stateDelay
+     * 
+     */
+    struct PendingState
+    {
+        const Box *box;                     ///< box which received the package
+        size_t roboter;                     ///< roboter which sorted the package
+        unsigned long due;                  ///< time of the report
+        bool armed;                         ///< the hub read the ArrivConf## of the package, due is set
+    };
+
+    void onRead(int slaveAddress, ReceivedI2cMessage &message);
+    void onWrite(int slaveAddress, const WriteI2cMessage &message);
+    size_t onRequestFrame(uint8_t slaveAddress, uint8_t *buffer, size_t quantity);
+    void onReceiveFrame(uint8_t slaveAddress, const uint8_t *buffer, size_t length);
+    void onPublish(const String &topic, const String &msg);
+    void onSubscribe(const String &topic);
+    Roboter *findRoboter(int slaveAddress);
+    Roboter *findRoboter(const String &topic, const char *suffix, String &consignor);
+    const Box *findBox(const String &name) const;
+    void announceBoxes();
+    void sendState(const Box &box);
+    void send(const String &topic, const std::shared_ptr<Message> &message);
+
+    std::vector<Box> boxes;             ///< simulated boxes
+    std::vector<Roboter> roboters;      ///< simulated roboters
+    std::deque<PendingState> pendingStates;     ///< received packages the boxes report, in the order they were sorted
+    std::vector<unsigned long> lastReport;      ///< time of the last report of every box
+    unsigned long misdelivered = 0;     ///< PackageArrived writes before a box reported the package
+    unsigned long long msgId = 0;       ///< id counter of the box messages
+    unsigned long lastAnnouncement = 0; ///< time of the last announcement of the boxes
+    mutable std::recursive_mutex lock;  ///< the mqtt hooks run on the mqtt task in DUAL_CORE mode
+};
+
+#endif // SMARTFACTORYSIMULATION_H__
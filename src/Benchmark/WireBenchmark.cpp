@@ -0,0 +1,197 @@
+/**
+ * @file WireBenchmark.cpp
+ * @brief Benchmark of the JSON and the CBOR wire format on the native build
+ * 
+ * Every message is filled once like the hub or a box fills it. Encode is the
+ * serialization into the payload the mqtt client gets, decode the
+ * translation the mqtt callback does. Publish is the whole way into the mqtt
+ * client: JSON is built as String and handed over, CBOR is streamed into the
+ * client like CommunicationHub::publishBinary() does. Messages MessageCodec
+ * does not cover are only measured in JSON.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "WireBenchmark.h"
+
+#include <stdio.h>
+
+#include <Arduino.h>
+
+#include "AllocationCounter.h"
+#include "BenchmarkStatistics.h"
+#include "MessageCodec.h"
+#include "MessageTranslation.h"
+#include "MQTTCommunication.h"
+
+static size_t checksum = 0;         ///< keeps the results from being optimized away
+static const String wireTopic = "Sortic/SO1/handshake";     ///< topic of the measured publishes
+
+/**
+ * @brief Result of one format
+ * 
+ */
+struct WireResult
+{
+    double encodeNanos = 0;         ///< time of one encode
+    double decodeNanos = 0;         ///< time of one decode
+    double decodeAllocations = 0;   ///< allocations of one decode
+    double publishNanos = 0;        ///< time of one publish
+    double publishAllocations = 0;  ///< allocations of one publish
+    size_t bytes = 0;               ///< size of the payload
+};
+
+static WireResult measureJson(const std::shared_ptr<Message> &message, unsigned int messages)
+{
+    WireResult result;
+    String payload = Message::translateStructToString(message);
+    result.bytes = payload.length();
+
+    BenchmarkStopwatch encode;
+    for (unsigned int i = 0; i < messages; i++)
+    {
+        checksum += Message::translateStructToString(message).length();
+    }
+    result.encodeNanos = encode.elapsedMicros() * 1e3 / messages;
+
+    // the translation may parse in place, every decode gets a fresh copy like the mqtt buffer
+    unsigned long allocationsBefore = AllocationCounter::allocations();
+    BenchmarkStopwatch decode;
+    for (unsigned int i = 0; i < messages; i++)
+    {
+        char buffer[MAX_JSON_PARSE_SIZE];
+        memcpy(buffer, payload.c_str(), payload.length());
+        checksum += (size_t)Message::translateJsonToStruct(buffer, payload.length())->msgType;
+    }
+    result.decodeNanos = decode.elapsedMicros() * 1e3 / messages;
+    result.decodeAllocations = (double)(AllocationCounter::allocations() - allocationsBefore) / messages;
+
+    Communication client("wire", nullptr);
+    allocationsBefore = AllocationCounter::allocations();
+    BenchmarkStopwatch publish;
+    for (unsigned int i = 0; i < messages; i++)
+    {
+        client.publishMessage(wireTopic, Message::translateStructToString(message));
+    }
+    result.publishNanos = publish.elapsedMicros() * 1e3 / messages;
+    result.publishAllocations = (double)(AllocationCounter::allocations() - allocationsBefore) / messages;
+    return result;
+}
+
+static WireResult measureCbor(const std::shared_ptr<Message> &message, unsigned int messages, bool &failed)
+{
+    WireResult result;
+    uint8_t payload[MESSAGE_CODEC_MAX_SIZE];
+    result.bytes = MessageCodec::encode(*message, payload);
+
+    BenchmarkStopwatch encode;
+    for (unsigned int i = 0; i < messages; i++)
+    {
+        uint8_t buffer[MESSAGE_CODEC_MAX_SIZE];
+        checksum += MessageCodec::encode(*message, buffer);
+    }
+    result.encodeNanos = encode.elapsedMicros() * 1e3 / messages;
+
+    unsigned long allocationsBefore = AllocationCounter::allocations();
+    BenchmarkStopwatch decode;
+    for (unsigned int i = 0; i < messages; i++)
+    {
+        std::shared_ptr<Message> decoded = MessageCodec::decode(payload, result.bytes);
+        checksum += decoded ? (size_t)decoded->msgType : 0;
+    }
+    result.decodeNanos = decode.elapsedMicros() * 1e3 / messages;
+    result.decodeAllocations = (double)(AllocationCounter::allocations() - allocationsBefore) / messages;
+
+    Communication client("wire", nullptr);
+    allocationsBefore = AllocationCounter::allocations();
+    BenchmarkStopwatch publish;
+    for (unsigned int i = 0; i < messages; i++)
+    {
+        client.beginPublish(wireTopic, MessageCodec::encodedLength(*message));
+        checksum += MessageCodec::encode(*message, client);
+        client.endPublish();
+    }
+    result.publishNanos = publish.elapsedMicros() * 1e3 / messages;
+    result.publishAllocations = (double)(AllocationCounter::allocations() - allocationsBefore) / messages;
+
+    // the streamed payload must be the buffered one
+    String streamed;
+    Communication::onPublish = [&streamed](Communication &, const String &, const String &msg) { streamed = msg; };
+    client.beginPublish(wireTopic, MessageCodec::encodedLength(*message));
+    MessageCodec::encode(*message, client);
+    if (!client.endPublish() || streamed.length() != result.bytes || memcmp(payload, streamed.c_str(), result.bytes))
+    {
+        failed = true;
+    }
+    Communication::onPublish = nullptr;
+
+    // the decoded message must encode to the same payload
+    std::shared_ptr<Message> decoded = MessageCodec::decode(payload, result.bytes);
+    uint8_t again[MESSAGE_CODEC_MAX_SIZE];
+    if (!decoded || MessageCodec::encode(*decoded, again) != result.bytes || memcmp(payload, again, result.bytes))
+    {
+        failed = true;
+    }
+    return result;
+}
+
+static void measure(const char *name, const std::shared_ptr<Message> &message, unsigned int messages, bool &failed)
+{
+    WireResult json = measureJson(message, messages);
+    printf("  %-14s %-5s %9.1f %9.1f %9.2f %9.1f %9.2f %7zu\n", name, "json", json.encodeNanos, json.decodeNanos, json.decodeAllocations,
+           json.publishNanos, json.publishAllocations, json.bytes);
+    uint8_t probe[MESSAGE_CODEC_MAX_SIZE];
+    if (MessageCodec::encode(*message, probe) == 0)
+    {
+        return;
+    }
+    WireResult cbor = measureCbor(message, messages, failed);
+    printf("  %-14s %-5s %9.1f %9.1f %9.2f %9.1f %9.2f %7zu\n", "", "cbor", cbor.encodeNanos, cbor.decodeNanos, cbor.decodeAllocations,
+           cbor.publishNanos, cbor.publishAllocations, cbor.bytes);
+}
+
+int runWireBenchmark(unsigned int messages)
+{
+    std::shared_ptr<SBAvailableMessage> available(new SBAvailableMessage());
+    available->msgId = 123456;
+    available->msgConsignor = Consignor::SB1;
+    available->targetReg = "West";
+    available->line = 2;
+    std::shared_ptr<SBStateMessage> state(new SBStateMessage());
+    state->msgId = 123457;
+    state->msgConsignor = Consignor::SB1;
+    state->state = "RetreivedPackage";
+    std::shared_ptr<SBToSOHandshakeMessage> handshake(new SBToSOHandshakeMessage());
+    handshake->setMessage(123458, Consignor::SO1, "SB1", "SB1", "cargo", "West", 2);
+    std::shared_ptr<ErrorMessage> error(new ErrorMessage());
+    error->setMessage(123459, Consignor::SO1, true, false);
+    std::shared_ptr<BufferMessage> buffer(new BufferMessage());
+    buffer->setMessage(123460, Consignor::SO1, true, false);
+    std::shared_ptr<SOStateMessage> soState(new SOStateMessage());
+    soState->setMessage(123461, Consignor::SO1, "waitForSort");
+    std::shared_ptr<PackageMessage> package(new PackageMessage());
+    package->setMessage(123462, Consignor::SO1, 42, "cargo", "2", "West");
+
+    printf("Wire format: %u encodes and decodes per message\n", messages);
+    printf("  %-14s %-5s %9s %9s %9s %9s %9s %7s\n", "message", "", "enc ns", "dec ns", "dec alloc", "pub ns", "pub alloc", "bytes");
+    bool failed = false;
+    measure("SBAvailable", available, messages, failed);
+    measure("SBState", state, messages, failed);
+    measure("Handshake", handshake, messages, failed);
+    measure("Error", error, messages, failed);
+    measure("Buffer", buffer, messages, failed);
+    measure("SOState", soState, messages, failed);
+    measure("Package", package, messages, failed);
+    printf("  checksum %zu\n", checksum);
+
+    if (failed)
+    {
+        printf("a CBOR payload did not decode to the encoded message\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file WireBenchmark.h
+ * @brief Benchmark of the JSON and the CBOR wire format on the native build
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef WIREBENCHMARK_H__
+#define WIREBENCHMARK_H__
+
+/**
+ * @brief Encodes and decodes the hub and box messages with JSON and with MessageCodec
+ * 
+ * - reports ns per encode and decode, allocations per decode and the payload size
+ * - fails if a CBOR payload does not decode to the encoded message
+ * 
+ * @param messages - number of encodes and decodes per message type and format
+ * @return int - 0 on success
+ */
+int runWireBenchmark(unsigned int messages);
+
+#endif // WIREBENCHMARK_H__
@@ -10,12 +10,39 @@
  */
 
 #include "CommunicationCtrl.h"
+#include "CommunicationHub.h"
 
 //======================PUBLIC===========================================================
 
-CommunicationCtrl::CommunicationCtrl() : currentState(State::idle), doActionFPtr(&CommunicationCtrl::doAction_idle)
+CommunicationCtrl::CommunicationCtrl(CommunicationHub &hub, size_t index) :
+    hub(hub),
+    pBus(I2CSLAVEADDRUNO + index, &pReceivedI2cMessage, &pWriteI2cMessage)
 {
-    DBFUNCCALLln("CommunicationCtrl::CommunicationCtrl()");    
+    DBFUNCCALLln("CommunicationCtrl::CommunicationCtrl(CommunicationHub&, size_t)");
+    sortic.consignor = SORTIC_ID_PREFIX + String((unsigned int)(index + 1));
+
+    // the topics of the sortic never change, a lookup in the topic table compares strings
+    static const TopicKind ownKinds[] = {TopicKind::SorticStatus, TopicKind::SorticPosition, TopicKind::SorticPackage, TopicKind::SorticError,
+                                         TopicKind::SorticHandshake, TopicKind::SorticBuffer, TopicKind::SorticMetrics};
+    for (size_t i = 0; i < TOPIC_KIND_COUNT; i++)
+    {
+        sorticTopics[i] = HubTopicTable::CAPACITY;
+    }
+    for (TopicKind kind : ownKinds)
+    {
+        sorticTopics[(size_t)kind] = hub.getTopic(kind, sortic.consignor);
+    }
+    for (size_t box = 0; box < BOX_CONSIGNORS; box++)
+    {
+        boxTopics[box][0] = HubTopicTable::CAPACITY;
+        boxTopics[box][1] = HubTopicTable::CAPACITY;
+    }
+    entryAction_idle();     // the fsm starts in idle without calling its entry action
+#ifdef HUB_METRICS
+    stateSince = millis();
+    metricsSince = stateSince;
+    startTask(Task::PublishMetrics, METRICS_INTERVAL, METRICS_INTERVAL, &CommunicationCtrl::task_publishMetrics);
+#endif
 }
 
 CommunicationCtrl::~CommunicationCtrl()
@@ -23,10 +50,39 @@ CommunicationCtrl::~CommunicationCtrl()
     DBFUNCCALLln("CommunicationCtrl::~CommunicationCtrl()");
 }
 
-void CommunicationCtrl::loop()
+void CommunicationCtrl::runTasks()
+{
+    DBFUNCCALLln("CommunicationCtrl::runTasks()");
+    scheduler.run(millis());    // run due tasks
+}
+
+unsigned long CommunicationCtrl::loop()
 {
     DBFUNCCALLln("CommunicationCtrl::loop()");
-    process((this->*doActionFPtr)());   // do actions
+#ifdef HUB_METRICS
+    State state = fsm.getState();
+    unsigned long doStart = micros();
+#endif
+    Event e = fsm.doAction();   // do actions
+#ifdef HUB_METRICS
+    doActionHistograms[(size_t)state].add(micros() - doStart);
+#endif
+#ifdef PIPELINED_PACKAGES
+    // the packages in flight are confirmed in whatever state the next package is
+    if (e == Event::NoEvent)
+    {
+        e = confirmArrivals();
+    }
+#endif
+    process(e);
+
+    // a new event has to be handled right away, otherwise nothing happens before the next task
+    if (e != Event::NoEvent)
+    {
+        return 0;
+    }
+    unsigned long sleep = scheduler.timeToNextDeadline(millis());
+    return sleep < MQTT_POLL_INTERVAL ? sleep : MQTT_POLL_INTERVAL;
 }
 
 void CommunicationCtrl::loop(Event currentEvent)
@@ -37,135 +93,158 @@ void CommunicationCtrl::loop(Event currentEvent)
     process(currentEvent);
 
     // process generated event
-    process((this->*doActionFPtr)());
+    process(fsm.doAction());
 }
 
 //======================PRIVATE==========================================================
 
+//======================Transition-Table=================================================
+//=======================================================================================
+
+#define IGNORE(s, e)         {State::s, Event::e, TransitionKind::Ignore, State::s}
+#define INTERNAL(s, e)       {State::s, Event::e, TransitionKind::Internal, State::s}
+#define EXTERNAL(s, e, n)    {State::s, Event::e, TransitionKind::External, State::n}
+#define HISTORY(s, e)        {State::s, Event::e, TransitionKind::History, State::s}
+
+constexpr Transition<CommunicationCtrl::State, CommunicationCtrl::Event> CommunicationCtrl::transitionTable[STATE_COUNT][EVENT_COUNT] = 
+{
+    {   // idle
+        IGNORE(idle, NoEvent),
+        EXTERNAL(idle, Publish, publish),
+        EXTERNAL(idle, SearchBox, boxCommunication),
+        IGNORE(idle, BoxAvailable),
+        IGNORE(idle, ReqBox),
+        IGNORE(idle, AnswerReceived),
+        IGNORE(idle, NoAnswerReceived),
+        IGNORE(idle, SimulateBuffer),
+        EXTERNAL(idle, ArrivConfirmation, arrivConfirmation),
+        EXTERNAL(idle, Error, errorState),
+        IGNORE(idle, Resume),
+        IGNORE(idle, Reset)
+    },
+    {   // publish
+        EXTERNAL(publish, NoEvent, idle),
+        IGNORE(publish, Publish),
+        IGNORE(publish, SearchBox),
+        IGNORE(publish, BoxAvailable),
+        IGNORE(publish, ReqBox),
+        IGNORE(publish, AnswerReceived),
+        IGNORE(publish, NoAnswerReceived),
+        IGNORE(publish, SimulateBuffer),
+        IGNORE(publish, ArrivConfirmation),
+        EXTERNAL(publish, Error, errorState),
+        IGNORE(publish, Resume),
+        IGNORE(publish, Reset)
+    },
+    {   // boxCommunication
+        IGNORE(boxCommunication, NoEvent),
+        IGNORE(boxCommunication, Publish),
+        IGNORE(boxCommunication, SearchBox),
+        INTERNAL(boxCommunication, BoxAvailable),
+        INTERNAL(boxCommunication, ReqBox),
+        EXTERNAL(boxCommunication, AnswerReceived, idle),
+        INTERNAL(boxCommunication, NoAnswerReceived),   // the search runs again without the silent box
+        EXTERNAL(boxCommunication, SimulateBuffer, bufferSimulation),
+        IGNORE(boxCommunication, ArrivConfirmation),
+        EXTERNAL(boxCommunication, Error, errorState),
+        IGNORE(boxCommunication, Resume),
+        IGNORE(boxCommunication, Reset)
+    },
+    {   // arrivConfirmation
+        IGNORE(arrivConfirmation, NoEvent),
+        IGNORE(arrivConfirmation, Publish),
+        IGNORE(arrivConfirmation, SearchBox),
+        IGNORE(arrivConfirmation, BoxAvailable),
+        IGNORE(arrivConfirmation, ReqBox),
+        EXTERNAL(arrivConfirmation, AnswerReceived, idle),
+        IGNORE(arrivConfirmation, NoAnswerReceived),
+        IGNORE(arrivConfirmation, SimulateBuffer),
+        IGNORE(arrivConfirmation, ArrivConfirmation),
+        EXTERNAL(arrivConfirmation, Error, errorState),
+        IGNORE(arrivConfirmation, Resume),
+        IGNORE(arrivConfirmation, Reset)
+    },
+    {   // bufferSimulation
+        IGNORE(bufferSimulation, NoEvent),
+        IGNORE(bufferSimulation, Publish),
+        IGNORE(bufferSimulation, SearchBox),
+        IGNORE(bufferSimulation, BoxAvailable),
+        IGNORE(bufferSimulation, ReqBox),
+        EXTERNAL(bufferSimulation, AnswerReceived, idle),
+        IGNORE(bufferSimulation, NoAnswerReceived),
+        IGNORE(bufferSimulation, SimulateBuffer),
+        IGNORE(bufferSimulation, ArrivConfirmation),
+        EXTERNAL(bufferSimulation, Error, errorState),
+        IGNORE(bufferSimulation, Resume),
+        IGNORE(bufferSimulation, Reset)
+    },
+    {   // errorState
+        IGNORE(errorState, NoEvent),
+        IGNORE(errorState, Publish),
+        IGNORE(errorState, SearchBox),
+        IGNORE(errorState, BoxAvailable),
+        IGNORE(errorState, ReqBox),
+        IGNORE(errorState, AnswerReceived),
+        IGNORE(errorState, NoAnswerReceived),
+        IGNORE(errorState, SimulateBuffer),
+        IGNORE(errorState, ArrivConfirmation),
+        IGNORE(errorState, Error),
+        HISTORY(errorState, Resume),                    // return to the state before the error
+        EXTERNAL(errorState, Reset, resetState)
+    },
+    {   // resetState
+        IGNORE(resetState, NoEvent),
+        IGNORE(resetState, Publish),
+        IGNORE(resetState, SearchBox),
+        IGNORE(resetState, BoxAvailable),
+        IGNORE(resetState, ReqBox),
+        IGNORE(resetState, AnswerReceived),
+        IGNORE(resetState, NoAnswerReceived),
+        IGNORE(resetState, SimulateBuffer),
+        IGNORE(resetState, ArrivConfirmation),
+        IGNORE(resetState, Error),
+        EXTERNAL(resetState, Resume, idle),
+        IGNORE(resetState, Reset)
+    }
+};
+
+#undef IGNORE
+#undef INTERNAL
+#undef EXTERNAL
+#undef HISTORY
+
+constexpr StateActions<CommunicationCtrl, CommunicationCtrl::State, CommunicationCtrl::Event> CommunicationCtrl::stateTable[STATE_COUNT] = 
+{
+    {State::idle, &CommunicationCtrl::entryAction_idle, &CommunicationCtrl::doAction_idle, &CommunicationCtrl::exitAction_idle},
+    {State::publish, &CommunicationCtrl::entryAction_publish, &CommunicationCtrl::doAction_publish, &CommunicationCtrl::exitAction_publish},
+    {State::boxCommunication, &CommunicationCtrl::entryAction_boxCommunication, &CommunicationCtrl::doAction_boxCommunication, &CommunicationCtrl::exitAction_boxCommunication},
+    {State::arrivConfirmation, &CommunicationCtrl::entryAction_arrivCommunication, &CommunicationCtrl::doAction_arrivCommunication, &CommunicationCtrl::exitAction_arrivCommunication},
+    {State::bufferSimulation, &CommunicationCtrl::entryAction_bufferSimulation, &CommunicationCtrl::doAction_bufferSimulation, &CommunicationCtrl::exitAction_bufferSimulation},
+    {State::errorState, &CommunicationCtrl::entryAction_errorState, &CommunicationCtrl::doAction_errorState, &CommunicationCtrl::exitAction_errorState},
+    {State::resetState, &CommunicationCtrl::entryAction_resetState, &CommunicationCtrl::doAction_resetState, &CommunicationCtrl::exitAction_resetState}
+};
+
 void CommunicationCtrl::process(Event e)
 {
     DBFUNCCALLln("CommunicationCtrl::process(Event)");
-    DBEVENTln(String("CommunicationCtrl ") + decodeEvent(e));
-
-    // controll the finite state machine
-    // switch with current state and generated event to next state
-    switch (currentState)
+    DBEVENTVALln("CommunicationCtrl ", decodeEvent(e));
+    static_assert(isTransitionTableComplete(transitionTable), "transitionTable needs one entry for every (State, Event) pair in enum order");
+    static_assert(isStateTableComplete(stateTable), "stateTable needs the actions of every State in enum order");
+
+#ifdef HUB_METRICS
+    State before = fsm.getState();
+#endif
+
+    // look up the transition of the current state and event
+    fsm.process(e);
+#ifdef HUB_METRICS
+    if (fsm.getState() != before)
     {
-    case State::idle:
-        if (Event::Publish == e)
-        {
-            exitAction_idle();
-            entryAction_publish();
-        }
-        else if (Event::SearchBox == e)
-        {
-            exitAction_idle();
-            entryAction_boxCommunication(e);
-        }
-        else if (Event::ArrivConfirmation == e)
-        {
-            exitAction_idle();
-            entryAction_arrivCommunication();
-        }
-        else if (Event::Error == e)
-        {
-            exitAction_idle();
-            entryAction_errorState();
-        }
-        break;
-    case State::publish:
-        if (Event::NoEvent == e)
-        {
-            exitAction_publish();
-            entryAction_idle();
-        }
-        else if (Event::Error == e)
-        {
-            exitAction_publish();
-            entryAction_errorState();
-        }
-        break;
-    case State::boxCommunication:
-        if (Event::SimulateBuffer == e)
-        {
-            exitAction_boxCommunication();
-            entryAction_bufferSimulation();
-        }
-        else if (Event::BoxAvailable == e || Event::ReqBox == e)
-        {
-            exitAction_boxCommunication();
-            entryAction_boxCommunication(e);
-        }
-        else if (Event::AnswerReceived == e)
-        {
-            exitAction_boxCommunication();
-            entryAction_idle();
-        }
-        else if (Event::Error == e)
-        {
-            exitAction_boxCommunication();
-            entryAction_errorState();
-        }
-        break;
-    case State::arrivConfirmation:
-        if (Event::AnswerReceived == e)
-        {
-            exitAction_arrivCommunication();
-            entryAction_idle();
-        }
-        else if (Event::Error == e)
-        {
-            exitAction_arrivCommunication();
-            entryAction_errorState();
-        }
-    case State::errorState:
-        if (Event::Resume == e)
-        {
-            exitAction_errorState();
-            switch (lastStateBeforeError)
-            {
-            case State::idle:
-                entryAction_idle();
-                break;
-            case State::publish:
-                entryAction_publish();
-                break;
-            case State::boxCommunication:
-                entryAction_boxCommunication(e);
-                break;
-            case State::arrivConfirmation:
-                entryAction_arrivCommunication();
-                break;
-            case State::bufferSimulation:
-                entryAction_bufferSimulation();
-                break;
-            }
-        }
-        else if (Event::Reset == e)
-        {
-            exitAction_errorState();
-            entryAction_resetState();
-        }
-    case State::resetState:
-        if (Event::Resume == e)
-        {
-            exitAction_resetState();
-            entryAction_idle();
-        }
-        break;
-    case State::bufferSimulation:
-        if (Event::AnswerReceived == e)
-        {
-            exitAction_bufferSimulation();
-            entryAction_idle(); 
-        }
-        else if (Event::Error == e)
-        {
-            exitAction_bufferSimulation();
-            entryAction_errorState();
-        }       
-        break;
+        unsigned long now = millis();
+        dwellHistograms[(size_t)before].add(now - stateSince);
+        stateSince = now;
     }
+#endif
 }
 
 //======================State-Functions==================================================
@@ -176,12 +255,31 @@ void CommunicationCtrl::process(Event e)
 void CommunicationCtrl::entryAction_idle()
 {
     DBSTATUSln("Entering State: idle");
-    currentState = State::idle;                         // set current state
-    doActionFPtr = &CommunicationCtrl::doAction_idle;   // set do-action function
 
-    currentMillis = millis();
-    previousMillisCheckMQTT = currentMillis;
-    previousMillisCheckI2C = currentMillis;
+    // poll the slave all 400ms, the hub checks mqtt messages all 400ms while every sortic is idle
+    startTask(Task::PollI2c, I2C_POLL_INTERVAL, I2C_POLL_INTERVAL, &CommunicationCtrl::task_pollI2c);
+
+    // idle listens only to the boxes of the packages in flight, drop what an interrupted state left subscribed
+    HubSubscriptions::TopicSet keep;
+    for (size_t i = 0; i < ARRIVALS_IN_FLIGHT; i++)
+    {
+        if (arrivals[i].valid)
+        {
+            keep.set(boxTopic(TopicKind::BoxState, arrivals[i].consignor));
+        }
+    }
+    for (size_t box = 0; box < BOX_CONSIGNORS && boxPhase == Event::BoxAvailable; box++)
+    {
+        if (candidates >> box & 1)
+        {
+            keep.set(boxTopic(TopicKind::BoxHandshake, (Consignor)box));    // requests of the pipeline
+        }
+    }
+    if (boxPhase == Event::ReqBox)
+    {
+        keep.set(boxTopic(TopicKind::BoxHandshake, sortic.box));     // handshake of the pipeline
+    }
+    hub.setSubscriptions(subscribedTopics, keep);
 }
 
 CommunicationCtrl::Event CommunicationCtrl::doAction_idle()
@@ -189,20 +287,15 @@ CommunicationCtrl::Event CommunicationCtrl::doAction_idle()
     DBINFO1ln("State: idle");
     Event retVal = Event::NoEvent;
 
-    // send request to i2c slave all 400ms
-    currentMillis = millis();
-    if ((currentMillis - previousMillisCheckI2C) > 400)
-    {
-        previousMillisCheckI2C = millis();
-        pBus.readMessage();
-    }
-    
     // if received i2c event is not default event -> do actions
-    if(strcmp((char*)(gReceivedI2cMessage.event),"null#######"))
+    if (receivedOpcode != I2cOpcode::Null)
     {
         DBINFO2ln("Decode I2c Event");
         return decodeI2cEvent();
     }
+#ifdef PIPELINED_PACKAGES
+    runPipeline();
+#endif
     
     // TEST
     /*
@@ -215,20 +308,12 @@ CommunicationCtrl::Event CommunicationCtrl::doAction_idle()
     }*/
     // TEST
 
-    // check for mqtt messages all 400ms
-    currentMillis = millis();
-    if ((currentMillis - previousMillisCheckMQTT) > 400)
-    {
-        DBINFO2ln("Check for MQTT message")
-        previousMillisCheckMQTT = millis();
-        pComm.loop();                                           // Unhandled exception here, worked at date 13.12.19 and now not anymore
-    }
     if (!errorMessageBuffer.empty()) // Check for error
     {
         Event retVal = Event::NoEvent;
         while ( errorMessageBuffer.size() > 0)
         {
-            if ( errorMessageBuffer.front()->error &&  errorMessageBuffer.front()->token)
+            if ( errorMessageBuffer.front().error &&  errorMessageBuffer.front().token)
             {
                 retVal = Event::Error;
                 errorMessageBuffer.pop_front();
@@ -242,6 +327,9 @@ CommunicationCtrl::Event CommunicationCtrl::doAction_idle()
 void CommunicationCtrl::exitAction_idle()
 {
     DBSTATUSln("Leaving State: idle");
+
+    // the other states wait for messages, the hub checks mqtt on every pass
+    scheduler.stop((size_t)Task::PollI2c);
 }
 
 //======================publish==========================================================
@@ -250,54 +338,20 @@ void CommunicationCtrl::exitAction_idle()
 void CommunicationCtrl::entryAction_publish()
 {
     DBSTATUSln("Entering State: publish");
-    currentState = State::publish;                          // set current state
-    doActionFPtr = &CommunicationCtrl::doAction_publish;    // set do-action function
 }
 
 CommunicationCtrl::Event CommunicationCtrl::doAction_publish()
 {
     DBINFO1ln("State: publish")
 
-    // publish message dependent on received i2c message event
-    if (!strcmp(gReceivedI2cMessage.event, "PublishSTA#"))
-    {
-        DBINFO2ln("Publish state");
-        std::shared_ptr<SOStateMessage> tempMessage (new SOStateMessage());
-        tempMessage->setMessage(idCounter++, Consignor::SO1, decodeSorticState((SorticState)(gReceivedI2cMessage.state)));
-        pComm.publishMessage("Sortic/SO1/status", Message::translateStructToString(tempMessage));
-    }
-    if (!strcmp(gReceivedI2cMessage.event, "PublishPOS#"))
-    {
-        DBINFO2ln("Publish position");
-        std::shared_ptr<SOPositionMessage> tempMessage (new SOPositionMessage());
-        tempMessage->setMessage(idCounter++, Consignor::SO1, gReceivedI2cMessage.position);
-        pComm.publishMessage("Sortic/SO1/position", Message::translateStructToString(tempMessage));
-    }
-    if (!strcmp(gReceivedI2cMessage.event, "PublishPAC#"))
-    {
-        DBINFO2ln("Publish package");
-        std::shared_ptr<PackageMessage> tempMessage (new PackageMessage());
-        // correct interpretation of targetDest
-            // TODO
-        // get target reg from package
-            // TODO
-        tempMessage->setMessage(idCounter++, Consignor::SO1, gReceivedI2cMessage.packageId, "cargo", (String)(gReceivedI2cMessage.targetDest), sortic.targetReg);
-        pComm.publishMessage("Sortic/SO1/package", Message::translateStructToString(tempMessage));
-    }
-    if (!strcmp(gReceivedI2cMessage.event, "PublishERR#"))
+    publishI2cMessage();
+#ifdef PIPELINED_PACKAGES
+    // search the box of the package while the roboter carries it to the sort position
+    if (receivedOpcode == I2cOpcode::PublishPackage && boxPhase == Event::NoEvent)
     {
-        DBINFO2ln("Publish error");
-        std::shared_ptr<ErrorMessage> tempMessage (new ErrorMessage());
-        tempMessage->setMessage(idCounter++, Consignor::SO1, gReceivedI2cMessage.error, gReceivedI2cMessage.token);
-        pComm.publishMessage("Sortic/SO1/error", Message::translateStructToString(tempMessage));
-    }
-    if (!strcmp(gReceivedI2cMessage.event, "PublishINI#"))
-    {
-        DBINFO2ln("Publish init message");
-        std::shared_ptr<SOInitMessage> tempMessage (new SOInitMessage());
-        tempMessage->setMessage();
-        pComm.publishMessage("Sortic/SO1/status", Message::translateStructToString(tempMessage));
+        startBoxSearch();
     }
+#endif
     return CommunicationCtrl::Event::NoEvent;
 }
 
@@ -306,31 +360,45 @@ void CommunicationCtrl::exitAction_publish()
     DBSTATUSln("Leaving State: publish");
 
     // reset i2c received message event
-    strcpy(gReceivedI2cMessage.event, "null#######");
+    receivedOpcode = I2cOpcode::Null;
 }
 
 //======================boxCommunication=================================================
 //=======================================================================================
 
-void CommunicationCtrl::entryAction_boxCommunication(Event event)
+void CommunicationCtrl::entryAction_boxCommunication()
 {
     DBSTATUSln("Entering State: boxCommunication");
-    currentState = State::boxCommunication;                         // set current state
-    doActionFPtr = &CommunicationCtrl::doAction_boxCommunication;   // set do-action function
-    currentEvent = event;                                           // set current event
+
+    switch (boxPhase)
+    {
+    case Event::NoEvent:
+        startBoxSearch();
+        break;
+    case Event::SearchBox:
+        // Resume an interrupted search, the window was stopped on exit
+        startTask(Task::SearchWindow, TIME_BETWEEN_SUBSCRIBE, 0, nullptr);
+        break;
+    case Event::BoxAvailable:
+    case Event::ReqBox:
+        // Resume an interrupted handshake or take over the one of the pipeline
+        startHandshake();
+        break;
+    default:
+        break;      // the pipeline already holds the answer of the box
+    }
 }
 
 CommunicationCtrl::Event CommunicationCtrl::doAction_boxCommunication()
 {
     DBINFO1ln("State: boxCommunication");
-    pComm.loop();                           //Check for new Messages
     
     if (!errorMessageBuffer.empty())       // Check for error
     {
         Event retVal = Event::NoEvent;
         while( errorMessageBuffer.size() > 0)
         {
-            if ( errorMessageBuffer.front()->error &&  errorMessageBuffer.front()->token)
+            if ( errorMessageBuffer.front().error &&  errorMessageBuffer.front().token)
             {
                 retVal = Event::Error;
                 errorMessageBuffer.pop_front();
@@ -339,127 +407,26 @@ CommunicationCtrl::Event CommunicationCtrl::doAction_boxCommunication()
         return retVal;
     }
 
-    switch (this->currentEvent)
-    {
-    // Search an available box for the package
-    case Event::SearchBox:
-    {
-        // Subscribe to available boxes
-        if (sortic.actualLine == Line::UploadLine)
-        {
-            pComm.subscribe("Box/+/available");
-        }
-
-        // Check for Available Box and store best one
-        delay(TIME_BETWEEN_SUBSCRIBE);
-
-        // stay in the loop while no box available, because it's worsed case
-        if (!sbAvailableMessageBuffer.empty())
-        {
-            // dynamic box choice funktion noch implementieren
-            for (int i = 0; i < sbAvailableMessageBuffer.size(); i++)
-            {
-                if (sbAvailableMessageBuffer.at(i)->targetReg == sortic.targetReg)
-                {
-                    DBINFO2ln("Available box for target region detected");
-                    sortic.req = decodeConsignor(sbAvailableMessageBuffer.at(i)->msgConsignor);
-                    sortic.targetLine = (CommunicationCtrl::Line)sbAvailableMessageBuffer.at(i)->line;
-                    pComm.unsubscribe("Box/+/available");
-                    sbAvailableMessageBuffer.clear();
-                    previousMillisPublish = millis() - TIME_BETWEEN_PUBLISH; // for next state
-                    return Event::BoxAvailable;
-                }
-            }                
-            for (int i = 0; i < sbAvailableMessageBuffer.size(); i++)
-            {
-                if ((sbAvailableMessageBuffer.at(i)->targetReg == "-1"))
-                {
-                    // Implement dynamic box choice, now it will return everytime false!
-                        // TODO
-                    if (dynamicBoxChoice())
-                    {
-                        DBINFO2ln("Available box for target region detected");
-                        sortic.req = decodeConsignor(sbAvailableMessageBuffer.at(i)->msgConsignor);
-                        sortic.targetLine = (CommunicationCtrl::Line)sbAvailableMessageBuffer.at(i)->line;
-                        pComm.unsubscribe("Box/+/available");
-                        sbAvailableMessageBuffer.clear();
-                        previousMillisPublish = millis() - TIME_BETWEEN_PUBLISH; // for next state
-                        return Event::BoxAvailable;
-                    }                  
-                }
-            }
-            pComm.unsubscribe("Box/+/available");
-            sbAvailableMessageBuffer.clear();
-            return Event::SimulateBuffer;
-        }
-        return Event::NoEvent;
-        break;
-    }
-    // send request message to available box
-    case Event::BoxAvailable:
-    {
-        // Publish request to choiced box
-        std::shared_ptr<SBToSOHandshakeMessage> tempMessage(new SBToSOHandshakeMessage());
-        tempMessage->setMessage(idCounter++, Consignor::SO1, sortic.req);
-        pComm.subscribe("Box/" + String(sortic.req) + "/handshake");
-
-        currentMillis = millis();
-        if ((currentMillis - previousMillisPublish) > TIME_BETWEEN_PUBLISH)
-        {
-            previousMillisPublish = millis();
-            pComm.publishMessage("Sortic/SO1/handshake", Message::translateStructToString(tempMessage));
-        }
-        if (!handshakeMessageSBToSOBuffer.empty() && (decodeConsignor( handshakeMessageSBToSOBuffer.front()->msgConsignor) == sortic.req) && ( handshakeMessageSBToSOBuffer.front()->req == (String)"SO1"))
-        {
-            sortic.ack = sortic.req;
-            pComm.unsubscribe("Box/" + String(sortic.req) + "/handshake");
-            handshakeMessageSBToSOBuffer.clear();
-            previousMillisPublish = millis() - TIME_BETWEEN_PUBLISH;
-            return Event::ReqBox;
-        } 
-        return Event::NoEvent;
-        break;
-    }
-    // send acknoledge message to available box
-    case Event::ReqBox:
+    Event retVal = negotiateBox();
+    if (retVal == Event::AnswerReceived || retVal == Event::SimulateBuffer)
     {
-        // Receive Request from choiched box
-        std::shared_ptr<SBToSOHandshakeMessage> tempMessage2(new SBToSOHandshakeMessage());
-        tempMessage2->setMessage(idCounter++, Consignor::SO1, sortic.req, sortic.ack, sortic.cargo, sortic.targetReg, (int)sortic.targetLine);
-        pComm.subscribe("Box/" + (String)sortic.ack + "/handshake");
-
-        currentMillis = millis();
-        if ((currentMillis - previousMillisPublish) > TIME_BETWEEN_PUBLISH)
-        {
-            previousMillisPublish = millis();
-            pComm.publishMessage("Sortic/SO1/handshake", Message::translateStructToString(tempMessage2));
-        }
-        if (!handshakeMessageSBToSOBuffer.empty() && (decodeConsignor( handshakeMessageSBToSOBuffer.front()->msgConsignor) == sortic.ack) && (handshakeMessageSBToSOBuffer.front()->ack == (String) "SO1"))
-        {
-            pComm.unsubscribe("Box/" + String(sortic.ack) + "/handshake");
-            handshakeMessageSBToSOBuffer.clear();
-            return Event::AnswerReceived;
-        }
-        return Event::NoEvent;
-        break;
-    }
-    default:
-        return Event::Error;
+        boxPhase = Event::NoEvent;      // the package leaves the box search
     }
+    return retVal;
 }
 
 void CommunicationCtrl::exitAction_boxCommunication()
 {
     DBSTATUSln("Leaving State: boxCommunication");
-    // reset received i2c event
-    strcpy(gReceivedI2cMessage.event, "null#######");
+    scheduler.stop((size_t)Task::SearchWindow);
+    scheduler.stop((size_t)Task::PublishHandshake);
 
-    // set i2c write event
-    strcpy(gWriteI2cMessage.event, "SortPackage");
-    gWriteI2cMessage.targetLine = (uint8_t)sortic.targetLine;
+    // reset received i2c event
+    receivedOpcode = I2cOpcode::Null;
 
-    // write i2c message to slave
-    pBus.writeMessage();
+    // write i2c sort package event to slave
+    pWriteI2cMessage.targetLine = (uint8_t)sortic.targetLine;
+    writeI2cMessage(I2cOpcode::SortPackage);
 }
 
 //======================arrivCommunication===============================================
@@ -468,22 +435,21 @@ void CommunicationCtrl::exitAction_boxCommunication()
 void CommunicationCtrl::entryAction_arrivCommunication()
 {
     DBSTATUSln("Entering State: arrivCommunication");
-    currentState = State::arrivConfirmation;                                // set current state
-    doActionFPtr = &CommunicationCtrl::doAction_arrivCommunication;         // set do-action function
-    pComm.subscribe("Box/" + (String)sortic.ack + "/state");
+
+    // the next package may negotiate its box meanwhile, the table keeps the box of this one
+    currentArrival = trackArrival();
 }
 
 CommunicationCtrl::Event CommunicationCtrl::doAction_arrivCommunication()
 {
     DBINFO1ln("State: arrivCommunication");
-    pComm.loop();
 
     if (!errorMessageBuffer.empty())       // Check for error
     {
         Event retVal = Event::NoEvent;
         while( errorMessageBuffer.size() > 0)
         {
-            if ( errorMessageBuffer.front()->error &&  errorMessageBuffer.front()->token)
+            if ( errorMessageBuffer.front().error &&  errorMessageBuffer.front().token)
             {
                 retVal = Event::Error;
                 errorMessageBuffer.pop_front();
@@ -491,24 +457,23 @@ CommunicationCtrl::Event CommunicationCtrl::doAction_arrivCommunication()
         }
         return retVal;
     }
-    // if state of delivered smart box is retreived package -> write message to slave
-    if (!sbStateMessageBuffer.empty())
+    if (currentArrival == ARRIVALS_IN_FLIGHT)
     {
-        if ((sbStateMessageBuffer.front()->state).equals("RetreivedPackage"))
-        {
-            pComm.unsubscribe("Box/" + (String)sortic.ack + "/state");
-            sbStateMessageBuffer.clear();
-
-            // set write i2c message event to package arrive
-            strcpy(gWriteI2cMessage.event, "PackageArri");
-
-            // write i2c message to slave
-            pBus.writeMessage();
-
-            return Event::AnswerReceived;
-        }
+        DBERROR("No free entry in the arrival table");
+        return Event::Error;
     }
-    return Event::NoEvent;
+#ifdef PIPELINED_PACKAGES
+    // loop() confirms the arrivals in every state, the roboter may go on with the next package
+    return Event::AnswerReceived;
+#else
+    // wait till the box of this package retreived it
+    Event retVal = confirmArrivals();
+    if (retVal == Event::NoEvent && !arrivals[currentArrival].valid)
+    {
+        retVal = Event::AnswerReceived;
+    }
+    return retVal;
+#endif
 }
 
 void CommunicationCtrl::exitAction_arrivCommunication()
@@ -516,7 +481,7 @@ void CommunicationCtrl::exitAction_arrivCommunication()
     DBSTATUSln("Leaving State: arrivCommunication");
 
     // reset received i2c event
-    strcpy(gReceivedI2cMessage.event, "null#######");
+    receivedOpcode = I2cOpcode::Null;
 }
 
 //======================bufferSimulation=================================================
@@ -525,27 +490,24 @@ void CommunicationCtrl::exitAction_arrivCommunication()
 void CommunicationCtrl::entryAction_bufferSimulation()
 {
     DBSTATUSln("Entering State: bufferSimulation");
-    currentState = State::bufferSimulation;                                     // set current state
-    doActionFPtr = &CommunicationCtrl::doAction_bufferSimulation;               // set buffer simulation
 
     // publish buffer message to buffer topic
-    std::shared_ptr<BufferMessage> tempMessage (new BufferMessage());
-    tempMessage->setMessage(idCounter++, Consignor::SO1, true, false);
-    pComm.publishMessage("SO1/buffer", tempMessage->parseStructToString());
-    pComm.subscribe("SO1/buffer");
+    std::shared_ptr<BufferMessage> tempMessage = bufferMessagePool.acquire();
+    tempMessage->setMessage(hub.nextMessageId(), Consignor::SO1, true, false);
+    publish(TopicKind::SorticBuffer, tempMessage);
+    subscribe(sorticTopic(TopicKind::SorticBuffer));
 }
 
 CommunicationCtrl::Event CommunicationCtrl::doAction_bufferSimulation()
 {
     DBINFO1ln("State: bufferSimulation");
-    pComm.loop();
 
     if (!errorMessageBuffer.empty())       // Check for error
     {
         Event retVal = Event::NoEvent;
         while( errorMessageBuffer.size() > 0)
         {
-            if ( errorMessageBuffer.front()->error &&  errorMessageBuffer.front()->token)
+            if ( errorMessageBuffer.front().error &&  errorMessageBuffer.front().token)
             {
                 retVal = Event::Error;
                 errorMessageBuffer.pop_front();
@@ -557,16 +519,13 @@ CommunicationCtrl::Event CommunicationCtrl::doAction_bufferSimulation()
     // wait till buffer is cleared
     if (!soBufferMessageBuffer.empty())
     {
-        if (!soBufferMessageBuffer.front()->full && soBufferMessageBuffer.front()->cleared)
+        if (!soBufferMessageBuffer.front().full && soBufferMessageBuffer.front().cleared)
         {
-            pComm.unsubscribe("SO1/buffer");
+            unsubscribe(sorticTopic(TopicKind::SorticBuffer));
             soBufferMessageBuffer.clear();
 
-            // set i2c write message event to package arrived
-            strcpy(gWriteI2cMessage.event, "PackageArri");
-
-            // write i2c message to slave
-            pBus.writeMessage();
+            // write i2c package arrived event to slave
+            writeI2cMessage(I2cOpcode::PackageArrived);
 
             return Event::AnswerReceived;
         }
@@ -579,7 +538,7 @@ void CommunicationCtrl::exitAction_bufferSimulation()
     DBSTATUSln("Entering State: bufferSimulation");
 
     // reset received i2c message event
-    strcpy(gReceivedI2cMessage.event, "null#######");
+    receivedOpcode = I2cOpcode::Null;
 }
 
 //======================errorState=======================================================
@@ -588,15 +547,13 @@ void CommunicationCtrl::exitAction_bufferSimulation()
 void CommunicationCtrl::entryAction_errorState()
 {
     DBERROR("Entering State: errorState");
-    lastStateBeforeError = currentState;                                    // set last state before error
-    currentState = State::errorState;                                       // set current state
-    doActionFPtr = &CommunicationCtrl::doAction_errorState;                 // set do-action functions
 
     DBINFO2ln("Publish state");
     // publish state
-    std::shared_ptr<SOStateMessage> tempMessage (new SOStateMessage());
-    tempMessage->setMessage(idCounter++, Consignor::SO1, (String)("errorState"));
-    pComm.publishMessage("Sortic/SO1/status", Message::translateStructToString(tempMessage));
+    bypassCoalescer(PublishSlot::Status);
+    std::shared_ptr<SOStateMessage> tempMessage = soStateMessagePool.acquire();
+    tempMessage->setMessage(hub.nextMessageId(), Consignor::SO1, (String)("errorState"));
+    publish(TopicKind::SorticStatus, tempMessage);
     
 }
 
@@ -606,12 +563,12 @@ CommunicationCtrl::Event CommunicationCtrl::doAction_errorState()
     CommunicationCtrl::Event retVal = Event::NoEvent;
     while (!errorMessageBuffer.empty()) 
     {
-        if (!errorMessageBuffer.front()->error && !errorMessageBuffer.front()->token) 
+        if (!errorMessageBuffer.front().error && !errorMessageBuffer.front().token) 
         {
             retVal = Event::Resume;
             errorMessageBuffer.pop_front();
         } 
-        else if (errorMessageBuffer.front()->error && errorMessageBuffer.front()->token) 
+        else if (errorMessageBuffer.front().error && errorMessageBuffer.front().token) 
         {
             retVal = Event::Reset;
             errorMessageBuffer.pop_front();
@@ -631,14 +588,13 @@ void CommunicationCtrl::exitAction_errorState()
 void CommunicationCtrl::entryAction_resetState()
 {
     DBERROR("Entering State: resetState");
-    currentState = State::resetState;                                                               // set current state
-    doActionFPtr = &CommunicationCtrl::doAction_resetState;                                         // set do-action functions
 
     // publish state
     DBINFO2ln("Publish state");
-    std::shared_ptr<SOStateMessage> tempMessage (new SOStateMessage());
-    tempMessage->setMessage(idCounter++, Consignor::SO1, (String)("errorState"));
-    pComm.publishMessage("Sortic/SO1/status", Message::translateStructToString(tempMessage));
+    bypassCoalescer(PublishSlot::Status);
+    std::shared_ptr<SOStateMessage> tempMessage = soStateMessagePool.acquire();
+    tempMessage->setMessage(hub.nextMessageId(), Consignor::SO1, (String)("errorState"));
+    publish(TopicKind::SorticStatus, tempMessage);
 }
 
 CommunicationCtrl::Event CommunicationCtrl::doAction_resetState()
@@ -647,8 +603,6 @@ CommunicationCtrl::Event CommunicationCtrl::doAction_resetState()
 
     // reset all buffers
     errorMessageBuffer.clear();
-    sbAvailableMessageBuffer.clear();
-    sbPositionMessageBuffer.clear();
     sbStateMessageBuffer.clear();
     handshakeMessageSBToSOBuffer.clear();
     soBufferMessageBuffer.clear();
@@ -660,112 +614,713 @@ void CommunicationCtrl::exitAction_resetState()
 {
 
     DBSTATUSln("Leaving State: resetState");
+    String consignor = sortic.consignor;    // the consignor belongs to the sortic, not to the package
+    if (boxPhase == Event::BoxAvailable)
+    {
+        releaseBoxes(candidates);           // the requested boxes wait for an acknowledge which never comes
+    }
+    candidates = 0;
     sortic = {};  //reset struct
+    for (size_t i = 0; i < ARRIVALS_IN_FLIGHT; i++)
+    {
+        arrivals[i] = Arrival();
+    }
+    boxPhase = Event::NoEvent;
+    sortic.consignor = consignor;
 
 }
 
 //======================Aux-Functions====================================================
 //=======================================================================================
 
-bool CommunicationCtrl::dynamicBoxChoice()
+void CommunicationCtrl::startTask(Task task, unsigned long delay, unsigned long period, void (CommunicationCtrl::*action)())
 {
-    DBFUNCCALLln("CommunicationCtrl::dynamicBoxChoice()");
-    // Implementate dynamic box choice
-        // TODO
-    return false;
+    DBFUNCCALLln("CommunicationCtrl::startTask(Task, unsigned long, unsigned long, void (CommunicationCtrl::*)())");
+    scheduler.start((size_t)task, millis(), delay, period, action);
 }
 
-String CommunicationCtrl::decodeEvent(Event e)
+void CommunicationCtrl::publishI2cMessage()
 {
-    DBFUNCCALLln("CommunicationCtrl::decodeEvent(Event)");
-    switch (e)
+    DBFUNCCALLln("CommunicationCtrl::publishI2cMessage()");
+
+    // publish message dependent on received i2c message event
+    switch (receivedOpcode)
     {
-    case Event::NoEvent:
-        return (String)"NoEvent";
-    case Event::Publish:
-        return (String)"Publish";
-    case Event::SearchBox:
-        return (String)"SearchBox";
-    case Event::BoxAvailable:
-        return (String)"BoxAvailable";
-    case Event::ReqBox:
-        return (String)"ReqBox";
-    case Event::AnswerReceived:
-        return (String)"AnswerReceived";
-    case Event::NoAnswerReceived:
-        return (String)"NoAnswerReceived";
-    case Event::SimulateBuffer:
-        return (String)"SimulateBuffer";
-    case Event::ArrivConfirmation:
-        return (String)"ArrivConfirmation";
-    case Event::Error:
-        return (String)"Error";    
+    case I2cOpcode::PublishState:
+        DBINFO2ln("Publish state");
+        coalesce(PublishSlot::Status, pReceivedI2cMessage.state);
+        break;
+    case I2cOpcode::PublishPosition:
+        DBINFO2ln("Publish position");
+        coalesce(PublishSlot::Position, pReceivedI2cMessage.position);
+        break;
+    case I2cOpcode::PublishPackage:
+    {
+        DBINFO2ln("Publish package");
+        sortic.packageId = pReceivedI2cMessage.packageId;
+        std::shared_ptr<PackageMessage> tempMessage = packageMessagePool.acquire();
+        // correct interpretation of targetDest
+            // TODO
+        // get target reg from package
+            // TODO
+        tempMessage->setMessage(hub.nextMessageId(), Consignor::SO1, pReceivedI2cMessage.packageId, "cargo", (String)(pReceivedI2cMessage.targetDest), sortic.targetReg);
+        publish(TopicKind::SorticPackage, tempMessage);
+        break;
+    }
+    case I2cOpcode::PublishError:
+    {
+        DBINFO2ln("Publish error");
+        std::shared_ptr<ErrorMessage> tempMessage = errorMessagePool.acquire();
+        tempMessage->setMessage(hub.nextMessageId(), Consignor::SO1, pReceivedI2cMessage.error, pReceivedI2cMessage.token);
+        publish(TopicKind::SorticError, tempMessage);
+        break;
+    }
+    case I2cOpcode::PublishInit:
+    {
+        DBINFO2ln("Publish init message");
+        bypassCoalescer(PublishSlot::Status);
+        std::shared_ptr<SOInitMessage> tempMessage = soInitMessagePool.acquire();
+        tempMessage->setMessage();
+        publish(TopicKind::SorticStatus, tempMessage);
+        break;
+    }
     default:
-        return (String)"Decode failed";
+        break;
     }
 }
 
-CommunicationCtrl::Event CommunicationCtrl::decodeI2cEvent()
+void CommunicationCtrl::coalesce(PublishSlot slot, long value)
 {
-    DBFUNCCALLln("CommunicationCtrl::decodeI2cEvent()");
-    String eventString = gReceivedI2cMessage.event;
-    if (eventString.equals("null#######"))
+    DBFUNCCALLln("CommunicationCtrl::coalesce(PublishSlot, long)");
+    unsigned long now = millis();
+    if (!coalescer.offer((size_t)slot, value, now))
     {
-        return Event::NoEvent;
+        return;     // the value is published already
     }
-    else if (eventString.equals("PublishSTA#"))
+    if (coalescer.isDue((size_t)slot, now))
     {
-        return CommunicationCtrl::Event::Publish;
+        flushPublish(slot);
     }
-    else if (eventString.equals("PublishPOS#"))
+    else if (!scheduler.isActive((size_t)Task::FlushPublishes))
     {
-        return CommunicationCtrl::Event::Publish;
+        startTask(Task::FlushPublishes, coalescer.timeToDue(now), 0, &CommunicationCtrl::task_flushPublishes);
     }
-    else if (eventString.equals("PublishERR#"))
+}
+
+void CommunicationCtrl::flushPublish(PublishSlot slot)
+{
+    DBFUNCCALLln("CommunicationCtrl::flushPublish(PublishSlot)");
+    if (!coalescer.isPending((size_t)slot))
     {
-        return CommunicationCtrl::Event::Publish;
+        return;
     }
-    else if (eventString.equals("PublishPAC#"))
+    long value = coalescer.take((size_t)slot);
+    switch (slot)
     {
-        return CommunicationCtrl::Event::Publish;
-    }
-    else if (eventString.equals("BoxComm####"))
+    case PublishSlot::Status:
     {
-        return CommunicationCtrl::Event::SearchBox;
+        std::shared_ptr<SOStateMessage> tempMessage = soStateMessagePool.acquire();
+        tempMessage->setMessage(hub.nextMessageId(), Consignor::SO1, decodeSorticState((SorticState)value));
+        publish(TopicKind::SorticStatus, tempMessage);
+        break;
     }
-    else if (eventString.equals("ArrivConf##"))
+    case PublishSlot::Position:
     {
-        return CommunicationCtrl::Event::ArrivConfirmation;
+        std::shared_ptr<SOPositionMessage> tempMessage = soPositionMessagePool.acquire();
+        tempMessage->setMessage(hub.nextMessageId(), Consignor::SO1, (int)value);
+        publish(TopicKind::SorticPosition, tempMessage);
+        break;
     }
-    else
-    {
-        return CommunicationCtrl::Event::Error;
     }
 }
 
-String CommunicationCtrl::decodeSorticState(SorticState s)
+void CommunicationCtrl::bypassCoalescer(PublishSlot slot)
 {
-    DBFUNCCALLln("CommunicationCtrl::decodeSorticState(SorticState)");
-    switch(s)
+    DBFUNCCALLln("CommunicationCtrl::bypassCoalescer(PublishSlot)");
+    flushPublish(slot);
+    coalescer.forget((size_t)slot);
+}
+
+void CommunicationCtrl::task_flushPublishes()
+{
+    DBFUNCCALLln("CommunicationCtrl::task_flushPublishes()");
+    unsigned long now = millis();
+    for (size_t slot = 0; slot < PUBLISH_SLOT_COUNT; slot++)
     {
-        case SorticState::readRfidVal:
-            return "State::readRfidVal";
-        case SorticState::waitForSort:
-            return "State::waitForSort";
-        case SorticState::sortPackageInBox:
-            return "State::SortPackageCtrl";
-        case SorticState::waitForArriv:
-            return "State::waitForArriv";
-        case SorticState::errorState:
-            return "State::errorState";
-        case SorticState::resetState:
-            return "State::resetState";
-        default:
-            return "ERROR: No matching state";
+        if (coalescer.isDue(slot, now))
+        {
+            flushPublish((PublishSlot)slot);
+        }
+    }
+    unsigned long next = coalescer.timeToDue(now);
+    if (next != PublishCoalescer<PUBLISH_SLOT_COUNT>::NO_VALUE)
+    {
+        startTask(Task::FlushPublishes, next, 0, &CommunicationCtrl::task_flushPublishes);
     }
 }
 
-String CommunicationCtrl::decodeLineToString(Line line)
+void CommunicationCtrl::task_pollI2c()
+{
+    DBFUNCCALLln("CommunicationCtrl::task_pollI2c()");
+    readI2cMessage();
+}
+
+#ifdef HUB_METRICS
+void CommunicationCtrl::task_publishMetrics()
+{
+    DBFUNCCALLln("CommunicationCtrl::task_publishMetrics()");
+    static const char *const dwellNames[STATE_COUNT] = {"dwell/idle", "dwell/publish", "dwell/boxCommunication", "dwell/arrivConfirmation",
+                                                        "dwell/bufferSimulation", "dwell/errorState", "dwell/resetState"};
+    static const char *const doActionNames[STATE_COUNT] = {"do/idle", "do/publish", "do/boxCommunication", "do/arrivConfirmation",
+                                                           "do/bufferSimulation", "do/errorState", "do/resetState"};
+    static const char *const currentNames[STATE_COUNT] = {"current/idle", "current/publish", "current/boxCommunication", "current/arrivConfirmation",
+                                                          "current/bufferSimulation", "current/errorState", "current/resetState"};
+    typedef CborWriter<CborBufferSink> Writer;
+    unsigned long now = millis();
+
+    size_t histograms = i2cReadHistogram.getCount() > 0 ? 1 : 0;
+    for (size_t i = 0; i < STATE_COUNT; i++)
+    {
+        histograms += (dwellHistograms[i].getCount() > 0 ? 1 : 0) + (doActionHistograms[i].getCount() > 0 ? 1 : 0);
+    }
+
+    uint8_t buffer[METRICS_MAX_SIZE];
+    CborBufferSink sink(buffer, sizeof(buffer));
+    Writer writer(sink);
+    writer.selfDescribe();
+    writer.head(Writer::ARRAY, 4);
+    writer.text(sortic.consignor);
+    writer.head(Writer::UNSIGNED, now - metricsSince);
+    writer.head(Writer::ARRAY, histograms);
+    for (size_t i = 0; i < STATE_COUNT; i++)
+    {
+        if (dwellHistograms[i].getCount() > 0)
+        {
+            dwellHistograms[i].write(writer, dwellNames[i]);
+        }
+        if (doActionHistograms[i].getCount() > 0)
+        {
+            doActionHistograms[i].write(writer, doActionNames[i]);
+        }
+        dwellHistograms[i].reset();
+        doActionHistograms[i].reset();
+    }
+    if (i2cReadHistogram.getCount() > 0)
+    {
+        i2cReadHistogram.write(writer, "i2c/read");
+    }
+    i2cReadHistogram.reset();
+
+    // the current state is still open, its dwell is counted when the state is left
+    writer.head(Writer::ARRAY, 1);
+    writer.head(Writer::ARRAY, 2);
+    writer.text(currentNames[(size_t)fsm.getState()]);
+    writer.head(Writer::UNSIGNED, now - stateSince);
+    metricsSince = now;
+
+    if (writer.length() == 0)
+    {
+        DBWARNINGln("Metrics snapshot longer than METRICS_MAX_SIZE");
+        return;
+    }
+    if (!hub.publishPayload(hub.getTopicName(sorticTopic(TopicKind::SorticMetrics)), buffer, writer.length()))
+    {
+        DBWARNINGln("MQTT client cannot publish binary payloads, metrics not sent");
+    }
+}
+#endif
+
+void CommunicationCtrl::startHandshake()
+{
+    DBFUNCCALLln("CommunicationCtrl::startHandshake()");
+    handshakeAttempts = 0;
+    startTask(Task::PublishHandshake, 0, 0, &CommunicationCtrl::task_publishHandshake);
+}
+
+void CommunicationCtrl::scheduleHandshake()
+{
+    DBFUNCCALLln("CommunicationCtrl::scheduleHandshake()");
+
+    // double the time on every retry, leave out a random part so the sortics do not retry in step
+    unsigned long backoff = HANDSHAKE_BACKOFF_MAX;
+    if (handshakeAttempts < 16 && ((unsigned long)TIME_BETWEEN_PUBLISH << handshakeAttempts) < backoff)
+    {
+        backoff = (unsigned long)TIME_BETWEEN_PUBLISH << handshakeAttempts;
+    }
+    backoff -= (unsigned long)random((long)(backoff / 2 + 1));
+
+    // after the last retry the task only waits for the answer, then negotiateBox() gives up
+    handshakeAttempts++;
+    startTask(Task::PublishHandshake, backoff, 0, handshakeAttempts <= HANDSHAKE_RETRIES ? &CommunicationCtrl::task_publishHandshake : nullptr);
+}
+
+CommunicationCtrl::Event CommunicationCtrl::chooseAnotherBox(HubBoxIndex::BoxMask boxes)
+{
+    DBFUNCCALLln("CommunicationCtrl::chooseAnotherBox(HubBoxIndex::BoxMask)");
+    DBWARNINGln("Box did not answer the handshake, search another box");
+
+    // a late answer must not reserve the box, it returns to the index with its next available message
+    releaseBoxes(boxes);
+    for (size_t box = 0; box < BOX_CONSIGNORS; box++)
+    {
+        if (boxes >> box & 1)
+        {
+            hub.getBoxIndex().remove(box);
+        }
+    }
+    candidates = 0;
+    handshakeMessageSBToSOBuffer.clear();
+    startBoxSearch();
+    return Event::NoAnswerReceived;
+}
+
+void CommunicationCtrl::task_publishHandshake()
+{
+    DBFUNCCALLln("CommunicationCtrl::task_publishHandshake()");
+    std::shared_ptr<SBToSOHandshakeMessage> tempMessage = handshakeMessagePool.acquire();
+    switch (boxPhase)
+    {
+    case Event::BoxAvailable:
+        for (size_t box = 0; box < BOX_CONSIGNORS; box++)
+        {
+            if (candidates >> box & 1)
+            {
+                // subscribe before the request is out, the box may answer right away
+                String name = decodeConsignor((Consignor)box);
+                subscribe(boxTopic(TopicKind::BoxHandshake, (Consignor)box));
+                tempMessage->setMessage(hub.nextMessageId(), Consignor::SO1, name);
+                publish(TopicKind::SorticHandshake, tempMessage);
+            }
+        }
+        scheduleHandshake();
+        return;
+    case Event::ReqBox:
+        subscribe(boxTopic(TopicKind::BoxHandshake, sortic.box));
+        tempMessage->setMessage(hub.nextMessageId(), Consignor::SO1, sortic.req, sortic.ack, sortic.cargo, sortic.targetReg, (int)sortic.targetLine);
+        break;
+    default:
+        scheduler.stop((size_t)Task::PublishHandshake);
+        return;
+    }
+    publish(TopicKind::SorticHandshake, tempMessage);
+    scheduleHandshake();
+}
+
+size_t CommunicationCtrl::answeredBox(HubBoxIndex::BoxMask boxes, bool acknowledge)
+{
+    DBFUNCCALLln("CommunicationCtrl::answeredBox(HubBoxIndex::BoxMask, bool)");
+    // the newest answer is at the front, walk from the back so the first box which answered wins
+    for (size_t i = handshakeMessageSBToSOBuffer.size(); i-- > 0;)
+    {
+        const SBToSOHandshakeMessage &message = handshakeMessageSBToSOBuffer.at(i);
+        size_t box = (size_t)message.msgConsignor;
+        if (box < BOX_CONSIGNORS && (boxes >> box & 1) && (acknowledge ? message.ack : message.req) == sortic.consignor)
+        {
+            return box;
+        }
+    }
+    return BOX_CONSIGNORS;
+}
+
+void CommunicationCtrl::releaseBoxes(HubBoxIndex::BoxMask boxes)
+{
+    DBFUNCCALLln("CommunicationCtrl::releaseBoxes(HubBoxIndex::BoxMask)");
+    for (size_t box = 0; box < BOX_CONSIGNORS; box++)
+    {
+        if (boxes >> box & 1)
+        {
+            String name = decodeConsignor((Consignor)box);
+            unsubscribe(boxTopic(TopicKind::BoxHandshake, (Consignor)box));
+            std::shared_ptr<SBToSOHandshakeMessage> tempMessage = handshakeMessagePool.acquire();
+            tempMessage->setMessage(hub.nextMessageId(), Consignor::SO1, name, HANDSHAKE_RELEASE, sortic.cargo, sortic.targetReg, (int)sortic.targetLine);
+            publish(TopicKind::SorticHandshake, tempMessage);
+        }
+    }
+}
+
+size_t CommunicationCtrl::trackArrival()
+{
+    DBFUNCCALLln("CommunicationCtrl::trackArrival()");
+    size_t free = ARRIVALS_IN_FLIGHT;
+    for (size_t i = 0; i < ARRIVALS_IN_FLIGHT; i++)
+    {
+        if (!arrivals[i].valid)
+        {
+            free = free < ARRIVALS_IN_FLIGHT ? free : i;
+        }
+        else if (arrivals[i].consignor == sortic.box && arrivals[i].packageId == sortic.packageId)
+        {
+            return i;       // the roboter repeated its request, the package is tracked already
+        }
+    }
+    if (free == ARRIVALS_IN_FLIGHT)
+    {
+        return free;
+    }
+    Arrival &arrival = arrivals[free];
+    arrival.box = sortic.ack;
+    arrival.consignor = sortic.box;
+    arrival.packageId = sortic.packageId;
+    arrival.since = millis();
+    arrival.valid = true;
+    subscribe(boxTopic(TopicKind::BoxState, arrival.consignor));
+    return free;
+}
+
+CommunicationCtrl::Event CommunicationCtrl::confirmArrivals()
+{
+    DBFUNCCALLln("CommunicationCtrl::confirmArrivals()");
+
+    // every retreived package confirms the oldest package in flight to its box
+    while (!sbStateMessageBuffer.empty())
+    {
+        const SBStateMessage &state = sbStateMessageBuffer.front();
+        if (state.state.equals("RetreivedPackage"))
+        {
+            size_t oldest = ARRIVALS_IN_FLIGHT;
+            for (size_t i = 0; i < ARRIVALS_IN_FLIGHT; i++)
+            {
+                if (arrivals[i].valid && arrivals[i].consignor == state.msgConsignor &&
+                    (oldest == ARRIVALS_IN_FLIGHT || (long)(arrivals[i].since - arrivals[oldest].since) < 0))
+                {
+                    oldest = i;
+                }
+            }
+            if (oldest < ARRIVALS_IN_FLIGHT)
+            {
+                hub.countSortedPackage(arrivals[oldest].consignor);
+
+                // write i2c package arrived event to slave
+#ifdef I2C_BINARY_PROTOCOL
+                pBus.setWritePackageId((uint16_t)arrivals[oldest].packageId);
+#endif
+                writeI2cMessage(I2cOpcode::PackageArrived);
+                untrackArrival(oldest);
+            }
+        }
+        sbStateMessageBuffer.pop_front();
+    }
+
+    // a box which does not confirm in time is reported, only the current package stops the fsm
+    Event retVal = Event::NoEvent;
+    unsigned long now = millis();
+    for (size_t i = 0; i < ARRIVALS_IN_FLIGHT; i++)
+    {
+        if (arrivals[i].valid && now - arrivals[i].since > ARRIVAL_TIMEOUT)
+        {
+            DBWARNINGVALln("Box did not confirm the package in time, box consignor ", (long)arrivals[i].consignor);
+            std::shared_ptr<ErrorMessage> tempMessage = errorMessagePool.acquire();
+            tempMessage->setMessage(hub.nextMessageId(), Consignor::SO1, true, false);
+            publish(TopicKind::SorticError, tempMessage);
+            untrackArrival(i);
+            retVal = i == currentArrival ? Event::Error : retVal;
+        }
+    }
+    return retVal;
+}
+
+void CommunicationCtrl::untrackArrival(size_t index)
+{
+    DBFUNCCALLln("CommunicationCtrl::untrackArrival(size_t)");
+    arrivals[index].valid = false;
+    for (size_t i = 0; i < ARRIVALS_IN_FLIGHT; i++)
+    {
+        if (arrivals[i].valid && arrivals[i].consignor == arrivals[index].consignor)
+        {
+            return;     // another package waits for the same box
+        }
+    }
+    unsubscribe(boxTopic(TopicKind::BoxState, arrivals[index].consignor));
+}
+
+void CommunicationCtrl::startBoxSearch()
+{
+    DBFUNCCALLln("CommunicationCtrl::startBoxSearch()");
+    targetRegion = hub.getBoxIndex().region(sortic.targetReg);
+
+    // The hub always subscribes available boxes, ask them again only if no known box is left
+    if (!hub.getBoxIndex().any(millis()))
+    {
+        hub.refreshBoxes();
+    }
+    startTask(Task::SearchWindow, TIME_BETWEEN_SUBSCRIBE, 0, nullptr);
+    boxPhase = Event::SearchBox;
+}
+
+void CommunicationCtrl::runPipeline()
+{
+    DBFUNCCALLln("CommunicationCtrl::runPipeline()");
+    if (boxPhase == Event::NoEvent || boxPhase == Event::AnswerReceived)
+    {
+        return;     // nothing to negotiate, or the answer waits for the roboter
+    }
+    if (negotiateBox() == Event::SimulateBuffer)
+    {
+        // no box takes the package now, it searches again when the roboter asks
+        scheduler.stop((size_t)Task::SearchWindow);
+        boxPhase = Event::NoEvent;
+    }
+}
+
+CommunicationCtrl::Event CommunicationCtrl::negotiateBox()
+{
+    DBFUNCCALLln("CommunicationCtrl::negotiateBox()");
+
+    switch (boxPhase)
+    {
+    // Search an available box for the package
+    case Event::SearchBox:
+    {
+        // Close the search window early if a box for the target region is available
+        HubBoxIndex &boxes = hub.getBoxIndex();
+        unsigned long now = millis();
+        if (!boxes.available(targetRegion, now) && scheduler.isActive((size_t)Task::SearchWindow))
+        {
+            return Event::NoEvent;
+        }
+
+        // stay in the loop while no box available, because it's worsed case
+        if (boxes.any(now))
+        {
+            if (!dynamicBoxChoice())
+            {
+                return Event::SimulateBuffer;
+            }
+            DBINFO2ln("Available box for target region detected");
+            boxPhase = Event::BoxAvailable;
+            startHandshake();
+            return Event::BoxAvailable;
+        }
+        hub.refreshBoxes();
+        startTask(Task::SearchWindow, TIME_BETWEEN_SUBSCRIBE, 0, nullptr);    // no box answered, open a new search window
+        return Event::NoEvent;
+        break;
+    }
+    // send request message to available box
+    case Event::BoxAvailable:
+    {
+        // The requests to the candidates are published by task_publishHandshake, the first box which answers wins
+        size_t box = answeredBox(candidates, false);
+        if (box < BOX_CONSIGNORS)
+        {
+            releaseBoxes(candidates & ~((HubBoxIndex::BoxMask)1 << box));
+            candidates = 0;
+            sortic.box = (Consignor)box;
+            sortic.req = decodeConsignor(sortic.box);
+            sortic.targetLine = (CommunicationCtrl::Line)hub.getBoxIndex().line(box);
+            sortic.ack = sortic.req;
+            unsubscribe(boxTopic(TopicKind::BoxHandshake, sortic.box));
+            handshakeMessageSBToSOBuffer.clear();
+            boxPhase = Event::ReqBox;
+            startHandshake();
+            return Event::ReqBox;
+        } 
+        if (!scheduler.isActive((size_t)Task::PublishHandshake))
+        {
+            return chooseAnotherBox(candidates);     // no candidate answered the last request
+        }
+        return Event::NoEvent;
+        break;
+    }
+    // send acknoledge message to available box
+    case Event::ReqBox:
+    {
+        // Receive Request from choiched box, the acknowledge is published by task_publishHandshake
+        if (answeredBox((HubBoxIndex::BoxMask)1 << (size_t)sortic.box, true) < BOX_CONSIGNORS)
+        {
+            unsubscribe(boxTopic(TopicKind::BoxHandshake, sortic.box));
+            handshakeMessageSBToSOBuffer.clear();
+            scheduler.stop((size_t)Task::PublishHandshake);
+            boxPhase = Event::AnswerReceived;
+            return Event::AnswerReceived;
+        }
+        if (!scheduler.isActive((size_t)Task::PublishHandshake))
+        {
+            return chooseAnotherBox((HubBoxIndex::BoxMask)1 << (size_t)sortic.box);     // the box did not acknowledge
+        }
+        return Event::NoEvent;
+        break;
+    }
+    // the box acknowledged while the package waited in the pipeline
+    case Event::AnswerReceived:
+        return Event::AnswerReceived;
+    default:
+        return Event::Error;
+    }
+}
+
+bool CommunicationCtrl::dynamicBoxChoice()
+{
+    DBFUNCCALLln("CommunicationCtrl::dynamicBoxChoice()");
+    static_assert(HANDSHAKE_CANDIDATES > 0 && HANDSHAKE_CANDIDATES <= BOX_CONSIGNORS, "the handshake requests 1 to BOX_CONSIGNORS boxes");
+
+    // packages of other regions which wait for a box may need a free box more
+    long waiting = (long)hub.getWaitingPackages(sortic.targetReg);
+
+    // only boxes of the target region and free boxes can take the package
+    HubBoxIndex &boxes = hub.getBoxIndex();
+    unsigned long now = millis();
+    HubBoxIndex::BoxMask region = boxes.available(targetRegion, now);
+    HubBoxIndex::BoxMask free = targetRegion == HubBoxIndex::FREE_REGION ? 0 : boxes.available(HubBoxIndex::FREE_REGION, now);
+    long scores[HANDSHAKE_CANDIDATES] = {};
+    size_t ranked[HANDSHAKE_CANDIDATES];
+    size_t count = 0;
+    for (size_t box = 0; box < BOX_CONSIGNORS; box++)
+    {
+        long score;
+        if (region >> box & 1)
+        {
+            score = BOX_SCORE_REGION;
+        }
+        else if (free >> box & 1)
+        {
+            score = BOX_SCORE_FREE - BOX_SCORE_PENDING * waiting;
+        }
+        else
+        {
+            continue;                                       // box not available or collects another region
+        }
+        long distance = boxes.line(box) - (int)sortic.actualLine;
+        score -= BOX_SCORE_LINE * (distance < 0 ? -distance : distance);
+        unsigned int sorted = hub.getSortedPackages((Consignor)box);
+        score -= BOX_SCORE_FILL * (long)(sorted < BOX_SCORE_FILL_MAX ? sorted : BOX_SCORE_FILL_MAX);
+        if (score <= 0 || (count == HANDSHAKE_CANDIDATES && score <= scores[count - 1]))
+        {
+            continue;
+        }
+
+        // insert the box into the ranking, the worst candidate drops out, the first box wins a tie
+        size_t i = count < HANDSHAKE_CANDIDATES ? count++ : count - 1;
+        for (; i > 0 && scores[i - 1] < score; i--)
+        {
+            scores[i] = scores[i - 1];
+            ranked[i] = ranked[i - 1];
+        }
+        scores[i] = score;
+        ranked[i] = box;
+    }
+    if (count == 0)
+    {
+        return false;
+    }
+
+    candidates = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        candidates |= (HubBoxIndex::BoxMask)1 << ranked[i];
+    }
+    sortic.box = (Consignor)ranked[0];
+    sortic.req = decodeConsignor(sortic.box);
+    sortic.targetLine = (CommunicationCtrl::Line)boxes.line(ranked[0]);
+    return true;
+}
+
+bool CommunicationCtrl::isSearchingBox() const
+{
+    return boxPhase == Event::SearchBox;
+}
+
+const char *CommunicationCtrl::decodeEvent(Event e)
+{
+    DBFUNCCALLln("CommunicationCtrl::decodeEvent(Event)");
+    switch (e)
+    {
+    case Event::NoEvent:
+        return "NoEvent";
+    case Event::Publish:
+        return "Publish";
+    case Event::SearchBox:
+        return "SearchBox";
+    case Event::BoxAvailable:
+        return "BoxAvailable";
+    case Event::ReqBox:
+        return "ReqBox";
+    case Event::AnswerReceived:
+        return "AnswerReceived";
+    case Event::NoAnswerReceived:
+        return "NoAnswerReceived";
+    case Event::SimulateBuffer:
+        return "SimulateBuffer";
+    case Event::ArrivConfirmation:
+        return "ArrivConfirmation";
+    case Event::Error:
+        return "Error";    
+    default:
+        return "Decode failed";
+    }
+}
+
+CommunicationCtrl::Event CommunicationCtrl::decodeI2cEvent()
+{
+    DBFUNCCALLln("CommunicationCtrl::decodeI2cEvent()");
+    static const Event i2cOpcodeEvents[I2C_OPCODE_COUNT] = 
+    {
+        Event::NoEvent,             // Null
+        Event::Publish,             // PublishState
+        Event::Publish,             // PublishPosition
+        Event::Publish,             // PublishPackage
+        Event::Publish,             // PublishError
+        Event::Publish,             // PublishInit
+        Event::SearchBox,           // BoxCommunication
+        Event::ArrivConfirmation,   // ArrivConfirmation
+        Event::Error,               // SortPackage, only sent by the hub
+        Event::Error,               // PackageArrived, only sent by the hub
+        Event::Error                // Invalid
+    };
+    return i2cOpcodeEvents[(size_t)receivedOpcode];
+}
+
+void CommunicationCtrl::readI2cMessage()
+{
+    DBFUNCCALLln("CommunicationCtrl::readI2cMessage()");
+#ifdef HUB_METRICS
+    unsigned long readStart = micros();
+    pBus.readMessage();
+    i2cReadHistogram.add(micros() - readStart);
+#else
+    pBus.readMessage();
+#endif
+#ifdef I2C_BINARY_PROTOCOL
+    receivedOpcode = pBus.getReceivedOpcode();
+#else
+    receivedOpcode = I2cFrame::decodeLegacyEvent(pReceivedI2cMessage.event);
+#endif
+}
+
+void CommunicationCtrl::writeI2cMessage(I2cOpcode opcode)
+{
+    DBFUNCCALLln("CommunicationCtrl::writeI2cMessage(I2cOpcode)");
+#ifdef I2C_BINARY_PROTOCOL
+    pBus.setWriteOpcode(opcode);
+#else
+    strcpy(pWriteI2cMessage.event, I2cFrame::encodeLegacyEvent(opcode));
+#endif
+    pBus.writeMessage();
+}
+
+String CommunicationCtrl::decodeSorticState(SorticState s)
+{
+    DBFUNCCALLln("CommunicationCtrl::decodeSorticState(SorticState)");
+    switch(s)
+    {
+        case SorticState::readRfidVal:
+            return "State::readRfidVal";
+        case SorticState::waitForSort:
+            return "State::waitForSort";
+        case SorticState::sortPackageInBox:
+            return "State::SortPackageCtrl";
+        case SorticState::waitForArriv:
+            return "State::waitForArriv";
+        case SorticState::errorState:
+            return "State::errorState";
+        case SorticState::resetState:
+            return "State::resetState";
+        default:
+            return "ERROR: No matching state";
+    }
+}
+
+String CommunicationCtrl::decodeLineToString(Line line)
 {
     DBFUNCCALLln("CommunicationCtrl::decodeLineToString(Line)");
     switch (line)
@@ -803,82 +1358,135 @@ String CommunicationCtrl::decodeConsignor(Consignor consignor)
     }
 }
 
-/**
- * @brief MQTT callbackfunction which will called if a new mqtt message is available
- * 
- * - the callback function serialize the received message to the correct buffer
- * 
- * @param topic 
- * @param payload 
- * @param length 
- */
-void CommunicationCtrl::callback(char* topic, byte* payload, unsigned int length) 
+TopicHandle CommunicationCtrl::sorticTopic(TopicKind kind)
 {
-    DBFUNCCALLln("callback(const char*, byte*, unsigned int)");
-    String topic_str = String((char*)topic);
-    char payload_str[MAX_JSON_PARSE_SIZE];
+    DBFUNCCALLln("CommunicationCtrl::sorticTopic(TopicKind)");
+    TopicHandle handle = sorticTopics[(size_t)kind];
+    // a full table builds the topic in its scratch slot on every lookup
+    return handle < HubTopicTable::CAPACITY ? handle : hub.getTopic(kind, sortic.consignor);
+}
 
-    for (unsigned int i = 0; i < length; i++) 
-    {  // iterate message till lentgh caus it's not 0-terminated
-        payload_str[i] = (char)payload[i];
+TopicHandle CommunicationCtrl::boxTopic(TopicKind kind, Consignor box)
+{
+    DBFUNCCALLln("CommunicationCtrl::boxTopic(TopicKind, Consignor)");
+    TopicHandle &handle = boxTopics[(size_t)box][kind == TopicKind::BoxState ? 1 : 0];
+    if (handle < HubTopicTable::CAPACITY)
+    {
+        return handle;
     }
-    // void pointer to receive translatet messagestruct to store in correct messagebuffer
-    const std::shared_ptr<Message> tempMessage = Message::translateJsonToStruct(payload_str, MAX_JSON_PARSE_SIZE);
-    // store messagestruct to correct buffer, check for dublicated messages
-    switch ((Message::MessageType)tempMessage->msgType)
+    TopicHandle found = hub.getTopic(kind, decodeConsignor(box));
+    handle = found < HubTopicTable::CAPACITY ? found : handle;     // the scratch slot is not kept
+    return found;
+}
+
+void CommunicationCtrl::subscribe(TopicHandle handle)
+{
+    DBFUNCCALLln("CommunicationCtrl::subscribe(TopicHandle)");
+    hub.subscribe(subscribedTopics, handle);
+}
+
+void CommunicationCtrl::unsubscribe(TopicHandle handle)
+{
+    DBFUNCCALLln("CommunicationCtrl::unsubscribe(TopicHandle)");
+    hub.unsubscribe(subscribedTopics, handle);
+}
+
+void CommunicationCtrl::publish(TopicKind kind, const String &msg)
+{
+    DBFUNCCALLln("CommunicationCtrl::publish(TopicKind, const String&)");
+    hub.publishMessage(hub.getTopicName(sorticTopic(kind)), msg);
+}
+
+void CommunicationCtrl::publish(TopicKind kind, const std::shared_ptr<Message> &message)
+{
+    DBFUNCCALLln("CommunicationCtrl::publish(TopicKind, const std::shared_ptr<Message>&)");
+
+    // the topics of BINARY_WIRE_TOPICS get CBOR, messages the codec does not cover stay JSON
+    if ((BINARY_WIRE_TOPICS) >> (unsigned int)kind & 1 && hub.publishBinary(hub.getTopicName(sorticTopic(kind)), *message))
     {
-    case Message::MessageType::Error:
-        for (int i = 0; i < errorMessageBuffer.size(); i++)
+        return;
+    }
+    publish(kind, Message::translateStructToString(message));
+}
+
+bool CommunicationCtrl::isSubscribed(TopicHandle handle) const
+{
+    return handle < HubTopicTable::CAPACITY && subscribedTopics.test(handle);
+}
+
+bool CommunicationCtrl::isIdle() const
+{
+    return fsm.getState() == State::idle && (boxPhase == Event::NoEvent || boxPhase == Event::AnswerReceived);
+}
+
+bool CommunicationCtrl::nextArrival(Consignor box, unsigned long &since) const
+{
+    size_t reported = 0;
+    for (size_t i = 0; i < sbStateMessageBuffer.size(); i++)
+    {
+        const SBStateMessage &state = sbStateMessageBuffer.at(i);
+        if (state.msgConsignor == box && state.state.equals("RetreivedPackage"))
         {
-            if ((errorMessageBuffer.at(i)->msgId == tempMessage->msgId) && ( errorMessageBuffer.at(i)->msgConsignor == tempMessage->msgConsignor))
-            {
-                DBINFO3("Duplicated Message");
-                break;
-            } 
+            reported++;
         }
-        DBINFO3ln("Pushed error message to buffer");
-        errorMessageBuffer.push_front(std::dynamic_pointer_cast<ErrorMessage, Message>(tempMessage));
-        break;
-    case Message::MessageType::SBAvailable:
-        for (int i = 0; i <  sbAvailableMessageBuffer.size(); i++)
+    }
+
+    // same order as confirmArrivals(): older first, the lower entry on equal times
+    for (size_t i = 0; i < ARRIVALS_IN_FLIGHT; i++)
+    {
+        if (!arrivals[i].valid || arrivals[i].consignor != box)
+        {
+            continue;
+        }
+        size_t older = 0;
+        for (size_t j = 0; j < ARRIVALS_IN_FLIGHT; j++)
         {
-            if (( sbAvailableMessageBuffer.at(i)->msgId == tempMessage->msgId) && ( sbAvailableMessageBuffer.at(i)->msgConsignor == tempMessage->msgConsignor))
+            long age = (long)(arrivals[j].since - arrivals[i].since);
+            if (j != i && arrivals[j].valid && arrivals[j].consignor == box && (age < 0 || (age == 0 && j < i)))
             {
-                DBINFO3ln("Duplicated Message");
-                return;
-            } 
+                older++;
+            }
         }
-        DBINFO3ln("Pushed smartbox available message to buffer");
-        sbAvailableMessageBuffer.push_front(std::dynamic_pointer_cast<SBAvailableMessage, Message>(tempMessage));
+        if (older == reported)
+        {
+            since = arrivals[i].since;
+            return true;
+        }
+    }
+    return false;
+}
+
+void CommunicationCtrl::storeMessage(const Message &message)
+{
+    DBFUNCCALLln("CommunicationCtrl::storeMessage(const Message&)");
+
+    // store messagestruct to correct buffer
+    switch ((Message::MessageType)message.msgType)
+    {
+    case Message::MessageType::Error:
+        DBINFO3ln("Pushed error message to buffer");
+        errorMessageBuffer.push_front(static_cast<const ErrorMessage &>(message));
         break;
     case Message::MessageType::SBToSOHandshake:
-        for (int i = 0; i <  handshakeMessageSBToSOBuffer.size(); i++)
+    {
+        // the handshake topic of a box is shared, keep only the answers to this sortic
+        const SBToSOHandshakeMessage &handshake = static_cast<const SBToSOHandshakeMessage &>(message);
+        if (handshake.req == sortic.consignor || handshake.ack == sortic.consignor)
         {
-            if (( handshakeMessageSBToSOBuffer.at(i)->msgId == tempMessage->msgId) && ( handshakeMessageSBToSOBuffer.at(i)->msgConsignor == tempMessage->msgConsignor))
-            {
-                DBINFO3("Duplicated Message");
-                break;
-            } 
+            DBINFO3ln("Pushed smartbox to sortic handshake message to buffer");
+            handshakeMessageSBToSOBuffer.push_front(handshake);
         }
-        DBINFO3ln("Pushed smartbox to sortic handshake message to buffer");
-        handshakeMessageSBToSOBuffer.push_front(std::dynamic_pointer_cast<SBToSOHandshakeMessage, Message>(tempMessage));
+        break;
+    }
+    case Message::MessageType::SBState:
+        DBINFO3ln("Pushed smartbox state message to buffer");
+        sbStateMessageBuffer.push_front(static_cast<const SBStateMessage &>(message));
         break;
     case Message::MessageType::SOBuffer:
-        for (int i = 0; i <  soBufferMessageBuffer.size(); i++)
-        {
-            if (( soBufferMessageBuffer.at(i)->msgId == tempMessage->msgId) && ( soBufferMessageBuffer.at(i)->msgConsignor == tempMessage->msgConsignor))
-            {
-                DBINFO3("Duplicated Message");
-                break;
-            } 
-        }
         DBINFO3ln("Pushed smartbox to sortic handshake message to buffer");
-        soBufferMessageBuffer.push_front(std::dynamic_pointer_cast<BufferMessage, Message>(tempMessage));
+        soBufferMessageBuffer.push_front(static_cast<const BufferMessage &>(message));
         break;
     default:
         break;
     }
-    String currentMessage = topic_str + " " + payload_str;
-    DBINFO3("CurrMessage: ");
-    DBINFO3ln(currentMessage);
 }
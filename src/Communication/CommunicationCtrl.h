@@ -23,24 +23,44 @@
 #include "I2cCommunication.h"
 #include "MQTTCommunication.h"
 #include "MessageTranslation.h"
+#include "MessageCodec.h"
+#include "StateMachine.h"
+#include "I2cFrame.h"
+#include "RingBuffer.h"
+#include "MessagePool.h"
+#include "TopicTable.h"
+#include "SubscriptionManager.h"
+#include "BoxIndex.h"
+#include "PublishCoalescer.h"
+#include "TimerWheel.h"
+#ifdef I2C_BINARY_PROTOCOL
+#include "I2cFrameBus.h"
+#endif
+#ifdef DUAL_CORE
+#include "MqttWorker.h"
+#endif
+#ifdef HUB_METRICS
+#include "LatencyHistogram.h"
+#endif
 
 #define MASTER
 
-static struct ReceivedI2cMessage gReceivedI2cMessage;                                           ///< global instance of reiceved i2c message struc
-static struct WriteI2cMessage gWriteI2cMessage;                                                 ///< global instance of write i2c message struct
+class CommunicationHub;
 
-
-
-static std::deque<std::shared_ptr<ErrorMessage>> errorMessageBuffer;                            ///< global instance of deque with type ErrorMessage
-static std::deque<std::shared_ptr<SBAvailableMessage>> sbAvailableMessageBuffer;                ///< global instance of deque with type SBAvailableMessage
-static std::deque<std::shared_ptr<SBPositionMessage>> sbPositionMessageBuffer;                  ///< global instance of deque with type SBPositionMessage
-static std::deque<std::shared_ptr<SBStateMessage>> sbStateMessageBuffer;                        ///< global instance of deque with type SBStateMessage
-static std::deque<std::shared_ptr<SBToSOHandshakeMessage>> handshakeMessageSBToSOBuffer;        ///< global instance of deque with type SBToSOHandshakeMessage
-static std::deque<std::shared_ptr<BufferMessage>> soBufferMessageBuffer;                        ///< global instance of deque with type BufferMessage
+#ifdef DUAL_CORE
+typedef MqttWorker MqttClient;                                                      ///< mqtt client runs in its own task
+#else
+typedef Communication MqttClient;                                                   ///< mqtt client runs in the loop of the FSM
+#endif
+typedef TopicTable<TOPIC_TABLE_SIZE, TOPIC_TABLE_LENGTH> HubTopicTable;             ///< interned mqtt topics of all sortics of the hub
+typedef SubscriptionManager<MqttClient, HubTopicTable> HubSubscriptions;            ///< subscriptions of all sortics of the hub
+typedef BoxIndex<BOX_CONSIGNORS, BOX_REGIONS> HubBoxIndex;                          ///< available boxes of all sortics of the hub
 
 
 /**
- * @brief The Communication Controll class contains the FSM for the Sortic Communication Hub
+ * @brief The Communication Controll class contains the FSM of one Sortic roboter of the Communication Hub
+ * 
+ * - the hub owns the shared mqtt client, the instance owns the FSM, the i2c slave and the message buffers of its sortic
  * 
  */
 class CommunicationCtrl
@@ -68,6 +88,7 @@ class CommunicationCtrl
     struct Sortic 
     {
         String id = DEFAULT_HOSTNAME;                   ///< Sorticname / Hostname of the Sortic
+        String consignor = SORTIC_ID_PREFIX "1";        ///< consignor id of the sortic in topics and handshakes
         Line actualLine = Line::UploadLine;             ///< actual line
         Line targetLine = Line::UploadLine;             ///< target line
         String status = "null";                         ///< status of the Box FSM
@@ -76,6 +97,7 @@ class CommunicationCtrl
         String req = "-1";                              ///< req for handshake vehicle
         String targetReg = "null";                      ///< target region of the package
         String targetDet = "null";                      ///< target destination of the package
+        Consignor box = Consignor::DEFUALTCONSIGNOR;    ///< consignor of the chosen box
         unsigned int packageId = 0;                     ///< package id
     } sortic;                                           ///< instance of the sortic struct
 
@@ -96,14 +118,18 @@ class CommunicationCtrl
         ArrivConfirmation,
         Error,
         Resume,
-        Reset
+        Reset                           // keep last, used for EVENT_COUNT
     };
+
+    static constexpr size_t EVENT_COUNT = (size_t)Event::Reset + 1;     ///< number of events
     
     /**
      * @brief Construct a new Communication Ctrl object
      * 
+     * @param hub - hub which owns the shared mqtt client
+     * @param index - number of the sortic in the hub, selects its i2c slave address and consignor id
      */
-    CommunicationCtrl();
+    CommunicationCtrl(CommunicationHub &hub, size_t index);
 
     /**
      * @brief Destroy the Communication Ctrl object
@@ -111,11 +137,21 @@ class CommunicationCtrl
      */
     ~CommunicationCtrl();
 
+    /**
+     * @brief Runs the due tasks of the scheduler
+     * 
+     * - the hub runs the tasks of all sortics before it delivers the received mqtt messages,
+     *   so an answer to a message published by a task reaches loop() in the same pass
+     * 
+     */
+    void runTasks();
+
     /**
      * @brief Calls the do-function of the active state and hence generates Events
      * 
+     * @return unsigned long - time in ms until work is due again, the caller may sleep this long
      */
-    void loop();
+    unsigned long loop();
 
     /**
      * @brief Calls the do-function of the active state and hence generates Events
@@ -133,15 +169,50 @@ class CommunicationCtrl
     void setState(char *state);
 
     /**
-     * @brief MQTT callback function 
+     * @brief Store a received message in the buffer of its type
      * 
-     * - function will be used if a new message is available to receive and store the message
+     * - called by the hub for the topics this sortic subscribed
      * 
-     * @param topic 
-     * @param payload 
-     * @param length 
+     * @param message - translated message, duplicates are already dropped
      */
-    static void callback(char* topic, byte* payload, unsigned int length);
+    void storeMessage(const Message &message);
+
+    /**
+     * @brief Check whether this sortic subscribed a topic
+     * 
+     * @param handle - TopicHandle
+     * @return true 
+     * @return false 
+     */
+    bool isSubscribed(TopicHandle handle) const;
+
+    /**
+     * @brief Check whether the sortic searches a box for its package
+     * 
+     * @return true 
+     * @return false 
+     */
+    bool isSearchingBox() const;
+
+    /**
+     * @brief Check whether the FSM waits in idle for the next i2c event and no box handshake runs
+     * 
+     * @return true 
+     * @return false 
+     */
+    bool isIdle() const;
+
+    /**
+     * @brief Get the package of this sortic which the next RetreivedPackage of a box confirms
+     * 
+     * - reports already in the buffer confirm the oldest packages first
+     * 
+     * @param box - consignor of the box
+     * @param since - time the package was delivered, only set if true is returned
+     * @return true - the next report of the box confirms a package of this sortic
+     * @return false 
+     */
+    bool nextArrival(Consignor box, unsigned long &since) const;
 
     //======================PRIVATE==========================================================
     private:
@@ -158,7 +229,49 @@ class CommunicationCtrl
         arrivConfirmation,              
         bufferSimulation,
         errorState,
-        resetState
+        resetState                      // keep last, used for STATE_COUNT
+    };
+
+    static constexpr size_t STATE_COUNT = (size_t)State::resetState + 1;   ///< number of states
+
+    /**
+     * @brief Enum class holds all tasks of the scheduler
+     * 
+     */
+    enum class Task
+    {
+        PollI2c,                        ///< request the i2c message of the slave
+        PublishHandshake,               ///< publish and retransmit the handshake message
+        FlushPublishes,                 ///< publish the coalesced status and position
+        PublishMetrics,                 ///< publish the latency histograms, HUB_METRICS only
+        SearchWindow                    // keep last, used for TASK_COUNT
+    };
+
+    static constexpr size_t TASK_COUNT = (size_t)Task::SearchWindow + 1;   ///< number of tasks
+
+    /**
+     * @brief Enum class holds the topics whose messages are coalesced, see PublishCoalescer
+     * 
+     */
+    enum class PublishSlot
+    {
+        Status,                         ///< Sortic/SO<n>/status, value is the SorticState
+        Position                        // keep last, used for PUBLISH_SLOT_COUNT
+    };
+
+    static constexpr size_t PUBLISH_SLOT_COUNT = (size_t)PublishSlot::Position + 1;    ///< number of coalesced topics
+
+    /**
+     * @brief Delivered package which waits for the confirmation of its box
+     * 
+     */
+    struct Arrival
+    {
+        String box = "-1";                                  ///< id of the box, e.g. "SB1"
+        Consignor consignor = Consignor::DEFUALTCONSIGNOR;  ///< consignor of the box
+        unsigned int packageId = 0;                         ///< package id
+        unsigned long since = 0;                            ///< time the package was delivered
+        bool valid = false;                                 ///< entry is in flight
     };
 
     /**
@@ -175,32 +288,70 @@ class CommunicationCtrl
         resetState
     };
 
-    I2cCommunication pBus = I2cCommunication( I2CSLAVEADDRUNO, &gReceivedI2cMessage, &gWriteI2cMessage);            ///< instance of i2c communication
-    Communication pComm = Communication(DEFAULT_HOSTNAME, &callback);                                               ///< instance of mqtt communication
+    CommunicationHub &hub;                                                                                          ///< hub which owns the shared mqtt client
+    struct ReceivedI2cMessage pReceivedI2cMessage;                                                                  ///< instance of reiceved i2c message struct
+    struct WriteI2cMessage pWriteI2cMessage;                                                                        ///< instance of write i2c message struct
+#ifdef I2C_BINARY_PROTOCOL
+    I2cFrameBus pBus;                                                                                               ///< instance of i2c communication, binary frames
+#else
+    I2cCommunication pBus;                                                                                          ///< instance of i2c communication
+#endif
+    I2cOpcode receivedOpcode = I2cOpcode::Null;                                                                     ///< opcode of the last received i2c event
+    HubSubscriptions::TopicSet subscribedTopics;                                                                    ///< topics this sortic subscribed at the hub
+    TopicHandle sorticTopics[TOPIC_KIND_COUNT];                                                                     ///< topics of this sortic by kind, HubTopicTable::CAPACITY if not interned
+    TopicHandle boxTopics[BOX_CONSIGNORS][2];                                                                       ///< handshake and state topic of every box, HubTopicTable::CAPACITY until first used
+    size_t targetRegion = HubBoxIndex::NO_REGION;                                                                   ///< slot of sortic.targetReg in the HubBoxIndex
+    Event boxPhase = Event::NoEvent;                                                                                ///< step of the box search and handshake: SearchBox, BoxAvailable, ReqBox, AnswerReceived or NoEvent
+    HubBoxIndex::BoxMask candidates = 0;                                                                            ///< boxes the handshake requested in BoxAvailable
+    unsigned int handshakeAttempts = 0;                                                                             ///< handshake messages published in the current step
+    Arrival arrivals[ARRIVALS_IN_FLIGHT];                                                                           ///< delivered packages which wait for their box
+    size_t currentArrival = ARRIVALS_IN_FLIGHT;                                                                     ///< entry of the package in arrivConfirmation
     PackageMessage pPackage;                                                                                        ///< Instance of PackageMessage  
 
-    unsigned long long idCounter = 0;                                                                               ///< id counter to give every message a new id
-    State lastStateBeforeError;                                                                                     ///< holds last state to return after error                   
-    State currentState;                                                                                             ///< holds current state of the FSM
-    Event currentEvent;                                                                                             ///< holds current event of the FSM
-    unsigned long currentMillis = 0;                                                                                ///< store current time
-    unsigned long previousMillis = 0;                                                                               ///< store last time
-    unsigned long previousMillisPublish = 0;                                                                        ///< store last publish time
-    unsigned long previousMillisCheckMQTT = 0;                                                                      ///< store last time of check mqtt
-    unsigned long previousMillisCheckI2C = 0;                                                                       ///< store last time of chek i2c
+    RingBuffer<ErrorMessage, ERROR_BUFFER_SIZE, OverflowPolicy::DropNewest> errorMessageBuffer;                     ///< ring buffer with type ErrorMessage, keeps the first errors
+    RingBuffer<SBStateMessage, SBSTATE_BUFFER_SIZE> sbStateMessageBuffer;                                             ///< ring buffer with type SBStateMessage
+    RingBuffer<SBToSOHandshakeMessage, HANDSHAKE_BUFFER_SIZE> handshakeMessageSBToSOBuffer;                           ///< ring buffer with type SBToSOHandshakeMessage
+    RingBuffer<BufferMessage, SOBUFFER_BUFFER_SIZE> soBufferMessageBuffer;                                            ///< ring buffer with type BufferMessage
+
+    MessagePool<SOStateMessage> soStateMessagePool;                                                                 ///< reusable outgoing state messages
+    MessagePool<SOPositionMessage> soPositionMessagePool;                                                           ///< reusable outgoing position messages
+    MessagePool<PackageMessage> packageMessagePool;                                                                 ///< reusable outgoing package messages
+    MessagePool<ErrorMessage> errorMessagePool;                                                                     ///< reusable outgoing error messages
+    MessagePool<SOInitMessage> soInitMessagePool;                                                                   ///< reusable outgoing init messages
+    MessagePool<SBToSOHandshakeMessage> handshakeMessagePool;                                                       ///< reusable outgoing handshake messages
+    MessagePool<BufferMessage> bufferMessagePool;                                                                   ///< reusable outgoing buffer messages
+
+    PublishCoalescer<PUBLISH_SLOT_COUNT> coalescer = PublishCoalescer<PUBLISH_SLOT_COUNT>(PUBLISH_COALESCE_WINDOW);  ///< latest status and position of the roboter to publish
+
+    TimerWheel<CommunicationCtrl, TASK_COUNT> scheduler = TimerWheel<CommunicationCtrl, TASK_COUNT>(this);          ///< periodic and one-shot tasks
+
+#ifdef HUB_METRICS
+    LatencyHistogram<METRICS_BUCKETS> dwellHistograms[STATE_COUNT];                                                 ///< time in ms every state was occupied
+    LatencyHistogram<METRICS_BUCKETS> doActionHistograms[STATE_COUNT];                                              ///< time in us of the do-action of every state
+    LatencyHistogram<METRICS_BUCKETS> i2cReadHistogram;                                                             ///< time in us the i2c slave is read
+    unsigned long stateSince = 0;                                                                                   ///< time the current state was entered
+    unsigned long metricsSince = 0;                                                                                 ///< time of the last metrics snapshot
+#endif
 
 
     /**
-     * @brief Functionpointer to call the current states do-functions
+     * @brief Transition table of the FSM, one entry for every (State, Event) pair
      * 
      */
-    Event (CommunicationCtrl::*doActionFPtr)(void) = nullptr;
+    static const Transition<State, Event> transitionTable[STATE_COUNT][EVENT_COUNT];
 
     /**
-     * @brief Functionpointer to hand over mqtt callback function
+     * @brief Entry, do and exit actions of every state
      * 
      */
-    void (CommunicationCtrl::*callbackFPtr)(char* topic, byte* payload, unsigned int length) = nullptr;
+    static const StateActions<CommunicationCtrl, State, Event> stateTable[STATE_COUNT];
+
+    /**
+     * @brief Finite state machine, holds current state and current event
+     * 
+     */
+    StateMachine<CommunicationCtrl, State, Event, STATE_COUNT, EVENT_COUNT> fsm = 
+        StateMachine<CommunicationCtrl, State, Event, STATE_COUNT, EVENT_COUNT>(this, transitionTable, stateTable, State::idle, Event::NoEvent);
 
     /**
      * @brief changes the state of the FSM based on the event
@@ -245,7 +396,7 @@ class CommunicationCtrl
      * 
      * @todo correct interpretation of targetDest
      *       get target reg from package
-     *
+     * 
      * @return Event - gerated Event
      */
     Event doAction_publish();
@@ -259,17 +410,19 @@ class CommunicationCtrl
     /**
      * @brief entry action of the state box communication
      * 
+     * - on SearchBox look up the target region in the HubBoxIndex and open the search window
+     * - ask the boxes to announce themselves again if the HubBoxIndex is empty
+     * 
      */
-    void entryAction_boxCommunication(Event event);
+    void entryAction_boxCommunication();
 
     /**
      * @brief main action of the state box communication
      * 
-     * - subscribe to available box
-     * - wait to receive messages
-     * - choice optimal box
+     * - the hub collects available box messages in its HubBoxIndex, known boxes stay there between packages
+     * - close the search window as soon as a box for the target region is available
+     * - else choice optimal box after TIME_BETWEEN_SUBSCRIBE
      * - publish request to the chocen box
-     * - unsubscribe to available box
      * - subsrice to handshake requested box
      * - wait to receive message
      * - if ok, publish acknoledge
@@ -280,6 +433,63 @@ class CommunicationCtrl
      */
     Event doAction_boxCommunication();
 
+    /**
+     * @brief Start the box search for the package in sortic
+     * 
+     * - look up the target region in the HubBoxIndex, ask the boxes again if it is empty
+     * - open the search window, boxPhase is SearchBox
+     * 
+     */
+    void startBoxSearch();
+
+    /**
+     * @brief Run the current step of the box search and handshake given by boxPhase
+     * 
+     * - SearchBox: choose the candidates with dynamicBoxChoice(), SimulateBuffer if none fits
+     * - BoxAvailable: wait for the first candidate which answers the request, release the others
+     * - ReqBox: wait for the acknowledge of the chosen box
+     * - NoAnswerReceived if the boxes did not answer after HANDSHAKE_RETRIES, the search starts again without them
+     * - AnswerReceived: the handshake is done, the answer is kept until the package leaves boxCommunication
+     * 
+     * @return Event - BoxAvailable, ReqBox, AnswerReceived, NoAnswerReceived, SimulateBuffer or NoEvent
+     */
+    Event negotiateBox();
+
+    /**
+     * @brief Advance the box handshake of the next package outside of boxCommunication (PIPELINED_PACKAGES)
+     * 
+     * - the result is staged in boxPhase until the roboter asks with BoxComm
+     * - if no box fits, boxPhase is reset and the search runs again in boxCommunication
+     * 
+     */
+    void runPipeline();
+
+    /**
+     * @brief Add the package in sortic to the arrival table and subscribe the state of its box
+     * 
+     * @return size_t - entry of the package, ARRIVALS_IN_FLIGHT if the table is full
+     */
+    size_t trackArrival();
+
+    /**
+     * @brief Confirm the packages in flight with the received box states
+     * 
+     * - every RetreivedPackage of a box confirms its oldest package, the slave gets PackageArrived
+     * - the boxes confirm in any order, a slow box does not hold up the others
+     * - a package which waits longer than ARRIVAL_TIMEOUT is dropped from the table,
+     *   logged with its box and reported on the error topic
+     * 
+     * @return Event - Error if the package of currentArrival timed out, else NoEvent
+     */
+    Event confirmArrivals();
+
+    /**
+     * @brief Remove a package from the arrival table, unsubscribe its box if no other package waits for it
+     * 
+     * @param index - entry of the package
+     */
+    void untrackArrival(size_t index);
+
     /**
      * @brief exit action of the state box communication
      * 
@@ -292,16 +502,15 @@ class CommunicationCtrl
     /**
      * @brief entry action of the state arriv communication
      * 
-     * - subscribe to state of requested box
+     * - add the package to the arrival table, subscribe to state of requested box
      */
     void entryAction_arrivCommunication();
 
     /**
      * @brief main action of the state arriv communication
      * 
-     * - wait till box updated state
-     * - set i2c write message that package is arrived
-     * - write i2c message to slave
+     * - wait till box updated state, confirmArrivals() writes the package arrived message to the slave
+     * - with PIPELINED_PACKAGES return to idle at once, loop() confirms the packages in flight
      * 
      * @return Event - generated Event
      */
@@ -388,32 +597,171 @@ class CommunicationCtrl
      */
     void exitAction_resetState();
 
+    /**
+     * @brief Find the first of some boxes which answered the handshake of this sortic
+     * 
+     * @param boxes - boxes to look for
+     * @param acknowledge - true: the box acknowledged, false: the box answered the request
+     * @return size_t - consignor of the box which answered first, BOX_CONSIGNORS if none answered
+     */
+    size_t answeredBox(HubBoxIndex::BoxMask boxes, bool acknowledge);
+
+    /**
+     * @brief Release requested boxes which are not needed, unsubscribe their handshake
+     * 
+     * - the release is a handshake message with the acknowledge HANDSHAKE_RELEASE
+     * 
+     * @param boxes - boxes to release
+     */
+    void releaseBoxes(HubBoxIndex::BoxMask boxes);
+
     /**
      * @brief Choiche a possible box based on datas of how many boxes are available 
      *        and how many packages for a target region are ther to sort
      * 
-     * @todo Implement dynamic box choice
+     * - scores the boxes of the target region and the free boxes of the HubBoxIndex in one pass,
+     *   the best HANDSHAKE_CANDIDATES boxes become the candidates of the handshake
+     * - the best box sets sortic.req, sortic.box and sortic.targetLine
+     * - a box of the target region scores BOX_SCORE_REGION, a free box BOX_SCORE_FREE less BOX_SCORE_PENDING
+     *   for every package of another region which waits for a box, boxes of other regions are skipped
+     * - every line between the sortic and the box costs BOX_SCORE_LINE,
+     *   every package the hub sorted into the box BOX_SCORE_FILL, up to BOX_SCORE_FILL_MAX packages
      * 
-     * @return true 
-     * @return false 
+     * @return true - a box scored above 0
+     * @return false - sort the package into the buffer
      */
     bool dynamicBoxChoice();
 
+    /**
+     * @brief Start a task of the scheduler
+     * 
+     * @param task - Task
+     * @param delay - time until the first run
+     * @param period - time between the runs, 0 runs it once
+     * @param action - called when the task is due
+     */
+    void startTask(Task task, unsigned long delay, unsigned long period, void (CommunicationCtrl::*action)());
+
+    /**
+     * @brief Publish the message of the received i2c event
+     * 
+     * - status and position go through the coalescer, package, error and init are published right away
+     * 
+     */
+    void publishI2cMessage();
+
+    /**
+     * @brief Offer a reported value to the coalescer, publish it when its window is over
+     * 
+     * @param slot - PublishSlot
+     * @param value - reported value
+     */
+    void coalesce(PublishSlot slot, long value);
+
+    /**
+     * @brief Publish the pending value of a coalesced topic, nothing happens if none is pending
+     * 
+     * @param slot - PublishSlot
+     */
+    void flushPublish(PublishSlot slot);
+
+    /**
+     * @brief Publish the pending value of a coalesced topic before another message goes to it
+     * 
+     * - keeps the order on the topic, the next value is published even if it did not change
+     * 
+     * @param slot - PublishSlot
+     */
+    void bypassCoalescer(PublishSlot slot);
+
+    /**
+     * @brief Task: publish the coalesced values whose window is over
+     * 
+     */
+    void task_flushPublishes();
+
+#ifdef HUB_METRICS
+    /**
+     * @brief Task: publish the histograms on Sortic/<id>/metrics and start new ones
+     * 
+     * - CBOR [owner, interval ms, [[name, count, sum, max, [buckets]], ...], [[name, value], ...]],
+     *   bucket i counts the values up to 2^i - 1, the last bucket everything above
+     * - dwell/<state> in ms, do/<state> and i2c/read in us, empty histograms are left out
+     * - current/<state> is the time in ms the current state is occupied so far, its dwell
+     *   is only added to the histogram when the state is left
+     * 
+     */
+    void task_publishMetrics();
+#endif
+
+    /**
+     * @brief Task: request the i2c message of the slave
+     * 
+     */
+    void task_pollI2c();
+
+    /**
+     * @brief Publish the handshake message of a new handshake step right away
+     * 
+     */
+    void startHandshake();
+
+    /**
+     * @brief Schedule the next handshake message with exponential backoff and jitter
+     * 
+     * - the time starts at TIME_BETWEEN_PUBLISH and doubles up to HANDSHAKE_BACKOFF_MAX, up to half of it is left out at random
+     * - after HANDSHAKE_RETRIES retries the task waits once more without publishing, then the step has timed out
+     * 
+     */
+    void scheduleHandshake();
+
+    /**
+     * @brief Give up boxes which did not answer the handshake and search again
+     * 
+     * - the boxes are released and removed from the HubBoxIndex until they announce themselves again
+     * 
+     * @param boxes - boxes which did not answer
+     * @return Event - NoAnswerReceived
+     */
+    Event chooseAnotherBox(HubBoxIndex::BoxMask boxes);
+
+    /**
+     * @brief Task: publish the handshake message of the current handshake step
+     * 
+     * - BoxAvailable publishes the request to every candidate, ReqBox the acknowledge
+     * - schedules the next retry, see scheduleHandshake()
+     * 
+     */
+    void task_publishHandshake();
+
     /**
      * @brief decodes the event of the communication control to a string
      * 
      * @param e - Event
-     * @return String 
+     * @return const char* - static name, the trace log keeps the pointer
      */
-    String decodeEvent(Event e);
+    const char *decodeEvent(Event e);
 
     /**
-     * @brief decodes the received i2c event to communication control event
+     * @brief decodes the received i2c opcode to communication control event
      * 
      * @return Event 
      */
     Event decodeI2cEvent();
 
+    /**
+     * @brief reads the i2c message of the slave and decodes its event once to receivedOpcode
+     * 
+     */
+    void readI2cMessage();
+
+    /**
+     * @brief writes the i2c write message with the given event to the slave
+     * 
+     * @param opcode - I2cOpcode
+     */
+    void writeI2cMessage(I2cOpcode opcode);
+
     /**
      * @brief decodes the state of the sortic control to a string
      * 
@@ -446,6 +794,55 @@ class CommunicationCtrl
      */
     String decodeConsignor(Consignor consignor);
 
+    /**
+     * @brief Get a topic of this sortic, the handles are looked up in the constructor
+     * 
+     * @param kind - one of the Sortic kinds of TopicKind
+     * @return TopicHandle 
+     */
+    TopicHandle sorticTopic(TopicKind kind);
+
+    /**
+     * @brief Get a topic of a box, the handle is looked up on the first use of the box
+     * 
+     * @param kind - TopicKind::BoxHandshake or TopicKind::BoxState
+     * @param box - consignor of the box, below BOX_CONSIGNORS
+     * @return TopicHandle 
+     */
+    TopicHandle boxTopic(TopicKind kind, Consignor box);
+
+    /**
+     * @brief Subscribe a topic for this sortic
+     * 
+     * @param handle - TopicHandle
+     */
+    void subscribe(TopicHandle handle);
+
+    /**
+     * @brief Unsubscribe a topic of this sortic
+     * 
+     * @param handle - TopicHandle
+     */
+    void unsubscribe(TopicHandle handle);
+
+    /**
+     * @brief Publish a message on a topic of this sortic
+     * 
+     * @param kind - TopicKind
+     * @param msg - serialized message
+     */
+    void publish(TopicKind kind, const String &msg);
+
+    /**
+     * @brief Serialize a message and publish it on a topic of this sortic
+     * 
+     * - CBOR if the topic is in BINARY_WIRE_TOPICS and MessageCodec covers the message, else JSON
+     * 
+     * @param kind - TopicKind
+     * @param message - message to publish
+     */
+    void publish(TopicKind kind, const std::shared_ptr<Message> &message);
+
 };
 
 #endif // COMMUNICATIONCTRL_H__
\ No newline at end of file
@@ -0,0 +1,559 @@
+/**
+ * @file CommunicationHub.cpp
+ * @brief The Communication Hub runs the FSMs of several Sortic roboters on one mqtt connection
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "CommunicationHub.h"
+
+#include "MqttClientTraits.h"
+
+static std::atomic<CommunicationHub *> activeHub{nullptr};     ///< hub the mqtt callback routes to, read by the mqtt task in DUAL_CORE
+
+/**
+ * @brief Encodes a message into a streamed publish
+ * 
+ */
+struct MessageWriter
+{
+    const Message &message;     ///< message to encode
+
+    template <typename Client>
+    void operator()(Client &client) const { MessageCodec::encode(message, client); }
+};
+
+/**
+ * @brief Writes a payload into a streamed publish
+ * 
+ */
+struct PayloadWriter
+{
+    const uint8_t *payload;     ///< payload, may contain zero bytes
+    size_t length;              ///< length of the payload
+
+    template <typename Client>
+    void operator()(Client &client) const { client.write(payload, length); }
+};
+
+#ifdef TRACE_LOG
+/**
+ * @brief Output of the TraceLog drain which collects the lines into mqtt payloads
+ * 
+ */
+class TracePublisher
+{
+    public:
+
+    /**
+     * @brief Construct a new Trace Publisher object
+     * 
+     * @param hub - publishes the payloads
+     * @param topic - topic of the payloads
+     */
+    TracePublisher(CommunicationHub &hub, const String &topic) : hub(hub), topic(topic) {}
+
+    /**
+     * @brief Add a line, publish the collected ones first if it does not fit
+     * 
+     * @param line - formatted record
+     */
+    void print(const char *line)
+    {
+        size_t length = strlen(line);
+        length = length < sizeof(payload) ? length : sizeof(payload) - 1;
+        if (used + length >= sizeof(payload))
+        {
+            flush();
+        }
+        memcpy(payload + used, line, length);
+        used += length;
+        payload[used] = '\0';
+    }
+
+    /**
+     * @brief Publish the collected lines
+     * 
+     */
+    void flush()
+    {
+        if (used > 0)
+        {
+            hub.publishMessage(topic, String(payload));
+            used = 0;
+        }
+    }
+
+    private:
+
+    CommunicationHub &hub;                  ///< publishes the payloads
+    const String &topic;                    ///< topic of the payloads
+    char payload[TRACE_PUBLISH_SIZE];       ///< collected lines, 0-terminated
+    size_t used = 0;                        ///< length of the collected lines
+};
+#endif
+
+//======================PUBLIC===========================================================
+
+CommunicationHub::CommunicationHub(size_t sortics)
+{
+    DBFUNCCALLln("CommunicationHub::CommunicationHub(size_t)");
+    sorticCount = sortics < SORTIC_COUNT ? sortics : SORTIC_COUNT;
+    for (size_t i = 0; i < sorticCount; i++)
+    {
+        this->sortics[i].reset(new CommunicationCtrl(*this, i));
+    }
+
+    // the availability feed of the boxes stays subscribed, the HubBoxIndex caches it
+    boxAvailableTopic = topicTable.get(TopicKind::BoxAvailable, "+");
+    subscriptions.subscribe(hubTopics, boxAvailableTopic);
+    scheduler.start((size_t)Task::ServiceMqtt, millis(), MQTT_POLL_INTERVAL, MQTT_POLL_INTERVAL, &CommunicationHub::task_serviceMqtt);
+
+    // the echo of the own probe shows that the broker session still holds the subscriptions
+    probeTopic = topicTable.get(TopicKind::SorticProbe, MQTT_PROBE_OWNER);
+    subscriptions.subscribe(hubTopics, probeTopic);
+    scheduler.start((size_t)Task::ProbeMqtt, millis(), MQTT_PROBE_INTERVAL, MQTT_PROBE_INTERVAL, &CommunicationHub::task_probeMqtt);
+#ifdef HUB_METRICS
+    metricsSince = millis();
+    scheduler.start((size_t)Task::PublishMetrics, millis(), METRICS_INTERVAL, METRICS_INTERVAL, &CommunicationHub::task_publishMetrics);
+#endif
+}
+
+CommunicationHub::~CommunicationHub()
+{
+    DBFUNCCALLln("CommunicationHub::~CommunicationHub()");
+    CommunicationHub *self = this;
+    activeHub.compare_exchange_strong(self, nullptr, std::memory_order_acq_rel);    // pComm may still call back until it is destroyed
+}
+
+unsigned long CommunicationHub::loop()
+{
+    DBFUNCCALLln("CommunicationHub::loop()");
+#ifdef HUB_METRICS
+    unsigned long loopStart = micros();
+#endif
+
+    // while a sortic waits for messages, check mqtt on every pass
+    bool waiting = false;
+    for (size_t i = 0; i < sorticCount && !waiting; i++)
+    {
+        waiting = !sortics[i]->isIdle();
+    }
+    if (waiting != busy)
+    {
+        busy = waiting;
+        unsigned long period = busy ? MQTT_POLL_INTERVAL_BUSY : MQTT_POLL_INTERVAL;
+        scheduler.start((size_t)Task::ServiceMqtt, millis(), busy ? 0 : period, period, &CommunicationHub::task_serviceMqtt);
+    }
+    for (size_t i = 0; i < sorticCount; i++)
+    {
+        sortics[i]->runTasks();     // poll the slaves, publish handshakes
+    }
+    scheduler.run(millis());    // deliver received mqtt messages, answers to the publishes above included
+
+    unsigned long sleep = scheduler.timeToNextDeadline(millis());
+    for (size_t i = 0; i < sorticCount; i++)
+    {
+        unsigned long sorticSleep = sortics[i]->loop();
+        sleep = sorticSleep < sleep ? sorticSleep : sleep;
+    }
+#ifdef TRACE_LOG
+    // the trace is formatted in idle time only, it never adds a wake up
+    if (sleep > 0 && !busy)
+    {
+        traceLog.drain(TRACE_DRAIN_BATCH);
+    }
+#endif
+#ifdef HUB_METRICS
+    loopHistogram.add(micros() - loopStart);
+#endif
+    return sleep;
+}
+
+CommunicationCtrl &CommunicationHub::getSortic(size_t index)
+{
+    return *sortics[index];
+}
+
+size_t CommunicationHub::size() const
+{
+    return sorticCount;
+}
+
+TopicHandle CommunicationHub::getTopic(TopicKind kind, const String &owner)
+{
+    return topicTable.get(kind, owner);
+}
+
+const String &CommunicationHub::getTopicName(TopicHandle handle) const
+{
+    return topicTable.name(handle);
+}
+
+void CommunicationHub::subscribe(HubSubscriptions::TopicSet &topics, TopicHandle handle)
+{
+    DBFUNCCALLln("CommunicationHub::subscribe(HubSubscriptions::TopicSet&, TopicHandle)");
+    subscriptions.subscribe(topics, handle);
+}
+
+void CommunicationHub::unsubscribe(HubSubscriptions::TopicSet &topics, TopicHandle handle)
+{
+    DBFUNCCALLln("CommunicationHub::unsubscribe(HubSubscriptions::TopicSet&, TopicHandle)");
+    subscriptions.unsubscribe(topics, handle);
+}
+
+void CommunicationHub::setSubscriptions(HubSubscriptions::TopicSet &topics, const HubSubscriptions::TopicSet &set)
+{
+    DBFUNCCALLln("CommunicationHub::setSubscriptions(HubSubscriptions::TopicSet&, const HubSubscriptions::TopicSet&)");
+    subscriptions.apply(topics, set);
+}
+
+void CommunicationHub::publishMessage(const String &topic, const String &msg)
+{
+    pComm.publishMessage(topic, msg);
+}
+
+bool CommunicationHub::publishBinary(const String &topic, const Message &message)
+{
+    DBFUNCCALLln("CommunicationHub::publishBinary(const String&, const Message&)");
+    // the worker of DUAL_CORE queues whole payloads, it has no streaming publish
+    size_t streamed = MessageCodec::encodedLength(message);
+    if (streamed > 0 && streamed <= MESSAGE_CODEC_MAX_SIZE &&
+        MqttClientTraits::streamPayload(pComm, topic, streamed, MessageWriter{message}, MqttClientTraits::StreamingPublish<MqttClient>::type()))
+    {
+        return true;
+    }
+    uint8_t buffer[MESSAGE_CODEC_MAX_SIZE];
+    size_t length = MessageCodec::encode(message, buffer);
+    return length > 0 && publishPayload(topic, buffer, length);
+}
+
+bool CommunicationHub::publishPayload(const String &topic, const uint8_t *payload, size_t length)
+{
+    DBFUNCCALLln("CommunicationHub::publishPayload(const String&, const uint8_t*, size_t)");
+    if (MqttClientTraits::streamPayload(pComm, topic, length, PayloadWriter{payload, length}, MqttClientTraits::StreamingPublish<MqttClient>::type()))
+    {
+        return true;
+    }
+
+    // never through a String, a client which hands msg.c_str() on would cut it at the first zero byte
+#ifdef DUAL_CORE
+    return pComm.publishMessage(topic, payload, length);
+#else
+    return MqttClientTraits::publishBytes(pComm, topic, payload, length, MqttClientTraits::BinaryPublish<Communication>::type());
+#endif
+}
+
+unsigned long long CommunicationHub::nextMessageId()
+{
+    return idCounter++;
+}
+
+HubBoxIndex &CommunicationHub::getBoxIndex()
+{
+    return boxIndex;
+}
+
+void CommunicationHub::refreshBoxes()
+{
+    DBFUNCCALLln("CommunicationHub::refreshBoxes()");
+    unsigned long now = millis();
+    if (boxRefreshed && now - lastBoxRefresh < TIME_BETWEEN_SUBSCRIBE)
+    {
+        return;
+    }
+    boxRefreshed = true;
+    lastBoxRefresh = now;
+    subscriptions.refresh(boxAvailableTopic);
+}
+
+size_t CommunicationHub::getWaitingPackages(const String &region) const
+{
+    size_t waiting = 0;
+    for (size_t i = 0; i < sorticCount; i++)
+    {
+        if (sortics[i]->isSearchingBox() && sortics[i]->sortic.targetReg != region)
+        {
+            waiting++;
+        }
+    }
+    return waiting;
+}
+
+void CommunicationHub::countSortedPackage(Consignor box)
+{
+    if ((size_t)box < BOX_CONSIGNORS)
+    {
+        sortedPackages[(size_t)box]++;
+    }
+}
+
+unsigned int CommunicationHub::getSortedPackages(Consignor box) const
+{
+    return (size_t)box < BOX_CONSIGNORS ? sortedPackages[(size_t)box] : 0;
+}
+
+void CommunicationHub::resetSortedPackages(Consignor box)
+{
+    if ((size_t)box < BOX_CONSIGNORS)
+    {
+        sortedPackages[(size_t)box] = 0;
+    }
+}
+
+void CommunicationHub::resubscribe()
+{
+    DBFUNCCALLln("CommunicationHub::resubscribe()");
+    subscriptions.reapply();
+}
+
+unsigned long CommunicationHub::getSavedSubscriptionRequests() const
+{
+    return subscriptions.getSaved();
+}
+
+unsigned long CommunicationHub::getDroppedDuplicates() const
+{
+    return duplicateFilter.getDropped();
+}
+
+unsigned long CommunicationHub::getDroppedInboxMessages() const
+{
+#ifdef DUAL_CORE
+    return mqttInboxDropped;
+#else
+    return 0;
+#endif
+}
+
+unsigned long CommunicationHub::getMqttStalls() const
+{
+#ifdef DUAL_CORE
+    return pComm.getStalls();
+#else
+    return 0;
+#endif
+}
+
+#ifdef TRACE_LOG
+size_t CommunicationHub::publishTrace()
+{
+    DBFUNCCALLln("CommunicationHub::publishTrace()");
+    TracePublisher publisher(*this, topicTable.name(topicTable.get(TopicKind::SorticTrace, TRACE_OWNER)));
+    size_t published = traceLog.drain(TRACE_LOG_SIZE, publisher);
+    publisher.flush();
+    return published;
+}
+#endif
+
+/**
+ * @brief MQTT callbackfunction which will called if a new mqtt message is available
+ * 
+ * - the callback function serialize the received message and routes it to the sortics
+ * - the payload is translated in place, it is not copied and not 0-terminated
+ * 
+ * @param topic
+ * @param payload
+ * @param length
+ */
+void CommunicationHub::callback(char* topic, byte* payload, unsigned int length)
+{
+    DBFUNCCALLln("callback(const char*, byte*, unsigned int)");
+    DBINFO3("CurrMessage: ");
+    DBINFO3ln(topic);
+
+    CommunicationHub *hub = activeHub.load(std::memory_order_acquire);
+    if (!hub)
+    {
+        return;
+    }
+
+    // only topics the hub built itself are expected
+    TopicHandle handle;
+    if (!hub->topicTable.match(topic, handle))
+    {
+        DBWARNINGln("Dropped message of unknown topic");
+        return;
+    }
+
+    // the echo of the probe carries no message
+    if (handle == hub->probeTopic)
+    {
+        hub->probeEchoed = true;
+        return;
+    }
+
+    // the translator must not read past the payload of the mqtt client
+    if (length == 0 || length > MAX_JSON_PARSE_SIZE)
+    {
+        DBWARNINGln("Dropped message with invalid length");
+        return;
+    }
+
+    // translate the payload span of the mqtt client directly to the messagestruct, CBOR peers mark their payload
+    const std::shared_ptr<Message> tempMessage = MessageCodec::isBinary(payload, length) ? MessageCodec::decode(payload, length)
+                                                                                         : Message::translateJsonToStruct((char*)payload, length);
+    if (!tempMessage)
+    {
+        return;
+    }
+
+#ifdef DUAL_CORE
+    // hand the message to the FSM on the other core
+    ReceivedMessage *received = hub->mqttInbox.beginPush();
+    if (!received)
+    {
+        hub->mqttInboxDropped++;
+        DBWARNINGln("Dropped message, mqtt inbox full");
+        return;
+    }
+    received->handle = handle;
+    received->message = tempMessage;
+    hub->mqttInbox.endPush();
+#else
+    hub->routeMessage(handle, tempMessage);
+#endif
+}
+
+//======================PRIVATE==========================================================
+
+CommunicationHub::CallbackTarget::CallbackTarget(CommunicationHub *hub)
+{
+    activeHub.store(hub, std::memory_order_release);
+}
+
+void CommunicationHub::task_serviceMqtt()
+{
+    DBINFO2ln("Check for MQTT message");
+#ifdef HUB_METRICS
+    unsigned long pollStart = micros();
+#endif
+#ifdef DUAL_CORE
+    // the mqtt task polls the client, take over what it received
+    for (ReceivedMessage *received = mqttInbox.front(); received; received = mqttInbox.front())
+    {
+        routeMessage(received->handle, received->message);
+        received->message.reset();                          // free the message on this core
+        mqttInbox.pop();
+    }
+#else
+    pComm.loop();                                           // Unhandled exception here, worked at date 13.12.19 and now not anymore
+#endif
+#ifdef HUB_METRICS
+    mqttHistogram.add(micros() - pollStart);
+#endif
+}
+
+void CommunicationHub::task_probeMqtt()
+{
+    DBFUNCCALLln("CommunicationHub::task_probeMqtt()");
+    // a new broker session after a reconnect has no subscriptions, restore them
+    if (!probeEchoed.exchange(false))
+    {
+        DBSTATUSln("MQTT probe not echoed, resubscribe");
+        resubscribe();
+    }
+    publishMessage(topicTable.name(probeTopic), MQTT_PROBE_OWNER);
+}
+
+#ifdef HUB_METRICS
+void CommunicationHub::task_publishMetrics()
+{
+    DBFUNCCALLln("CommunicationHub::task_publishMetrics()");
+    unsigned long now = millis();
+    uint8_t buffer[METRICS_MAX_SIZE];
+    CborBufferSink sink(buffer, sizeof(buffer));
+    CborWriter<CborBufferSink> writer(sink);
+
+    // [owner, interval, [histograms], [values]], see CommunicationCtrl::task_publishMetrics()
+    writer.selfDescribe();
+    writer.head(CborWriter<CborBufferSink>::ARRAY, 4);
+    writer.text(METRICS_HUB_OWNER);
+    writer.head(CborWriter<CborBufferSink>::UNSIGNED, now - metricsSince);
+    writer.head(CborWriter<CborBufferSink>::ARRAY, 2);
+    loopHistogram.write(writer, "hub/loop");
+    mqttHistogram.write(writer, "mqtt/poll");
+    writer.head(CborWriter<CborBufferSink>::ARRAY, 2);
+    writer.head(CborWriter<CborBufferSink>::ARRAY, 2);
+    writer.text("mqtt/inboxDropped");
+    writer.head(CborWriter<CborBufferSink>::UNSIGNED, getDroppedInboxMessages());
+    writer.head(CborWriter<CborBufferSink>::ARRAY, 2);
+    writer.text("mqtt/stalls");
+    writer.head(CborWriter<CborBufferSink>::UNSIGNED, getMqttStalls());
+    if (writer.length() == 0)
+    {
+        DBWARNINGln("Metrics snapshot longer than METRICS_MAX_SIZE");
+    }
+    else if (!publishPayload(topicTable.name(topicTable.get(TopicKind::SorticMetrics, METRICS_HUB_OWNER)), buffer, writer.length()))
+    {
+        DBWARNINGln("MQTT client cannot publish binary payloads, metrics not sent");
+    }
+    loopHistogram.reset();
+    mqttHistogram.reset();
+    metricsSince = now;
+}
+#endif
+
+void CommunicationHub::routeMessage(TopicHandle handle, const std::shared_ptr<Message> &message)
+{
+    DBFUNCCALLln("CommunicationHub::routeMessage(TopicHandle, const std::shared_ptr<Message>&)");
+
+    bool duplicate = duplicateFilter.isDuplicate((size_t)message->msgConsignor, (size_t)message->msgType, message->msgId);
+
+    // index the available boxes, a free box is empty
+    // the retained message comes again with the same id after refreshBoxes(), it still renews the box
+    if (Message::MessageType::SBAvailable == (Message::MessageType)message->msgType)
+    {
+        const SBAvailableMessage &available = static_cast<const SBAvailableMessage &>(*message);
+        boxIndex.update((size_t)available.msgConsignor, available.targetReg, available.line, millis());
+        if (!duplicate && available.targetReg == "-1")
+        {
+            resetSortedPackages(available.msgConsignor);
+        }
+        return;
+    }
+
+    // drop dublicated messages
+    if (duplicate)
+    {
+        DBINFO3ln("Duplicated Message");
+        return;
+    }
+
+    // a box reports every received package once, only the sortic which delivered the oldest waiting package gets it
+    if (Message::MessageType::SBState == (Message::MessageType)message->msgType &&
+        static_cast<const SBStateMessage &>(*message).state.equals("RetreivedPackage"))
+    {
+        size_t receiver = sorticCount;
+        unsigned long oldest = 0;
+        for (size_t i = 0; i < sorticCount; i++)
+        {
+            unsigned long since;
+            if (sortics[i]->nextArrival(message->msgConsignor, since) &&
+                (receiver == sorticCount || (long)(since - oldest) < 0))
+            {
+                receiver = i;
+                oldest = since;
+            }
+        }
+        if (receiver < sorticCount)
+        {
+            sortics[receiver]->storeMessage(*message);
+            return;
+        }
+    }
+
+    // a topic of the scratch slot is not tracked, every sortic gets it
+    bool tracked = topicTable.isInterned(handle);
+    for (size_t i = 0; i < sorticCount; i++)
+    {
+        if (!tracked || sortics[i]->isSubscribed(handle))
+        {
+            sortics[i]->storeMessage(*message);
+        }
+    }
+}
@@ -0,0 +1,391 @@
+/**
+ * @file CommunicationHub.h
+ * @brief The Communication Hub runs the FSMs of several Sortic roboters on one mqtt connection
+ * 
+ * Every sortic has its own CommunicationCtrl with its FSM, i2c slave and
+ * topic namespace Sortic/SO<n>/. The hub owns what they share: the mqtt
+ * client, the topic table, the subscriptions, the duplicate filter and the
+ * message ids. A received message is translated and checked for duplicates
+ * once, then routed to every sortic which subscribed its topic.
+ * 
+ * The mqtt client calls a plain function without context, so there is one hub
+ * per process.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef COMMUNICATIONHUB_H__
+#define COMMUNICATIONHUB_H__
+
+#include <Arduino.h>
+#include <atomic>
+#include <memory>
+
+// own files:
+#include "LogConfiguration.h"
+#include "MainConfiguration.h"
+#include "CommunicationCtrl.h"
+#include "DuplicateFilter.h"
+#ifdef HUB_METRICS
+#include "LatencyHistogram.h"
+#endif
+#ifdef DUAL_CORE
+#include "SpscQueue.h"
+#endif
+
+/**
+ * @brief The Communication Hub runs the FSMs of several Sortic roboters on one mqtt connection
+ * 
+ */
+class CommunicationHub
+{
+    //======================PUBLIC===========================================================
+    public:
+
+    /**
+     * @brief Construct a new Communication Hub object
+     * 
+     * @param sortics - number of hosted sortics, at most SORTIC_COUNT
+     */
+    explicit CommunicationHub(size_t sortics = SORTIC_COUNT);
+
+    /**
+     * @brief Destroy the Communication Hub object
+     * 
+     */
+    ~CommunicationHub();
+
+    /**
+     * @brief Runs the due tasks of the hub and of every sortic, then the do-function of every sortic
+     * 
+     * @return unsigned long - time in ms until work is due again, the caller may sleep this long
+     */
+    unsigned long loop();
+
+    /**
+     * @brief Get a hosted sortic
+     * 
+     * @param index - number of the sortic, 0 is SO1
+     * @return CommunicationCtrl&
+     */
+    CommunicationCtrl &getSortic(size_t index);
+
+    /**
+     * @brief Get the number of hosted sortics
+     * 
+     * @return size_t
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get an interned mqtt topic, it is built on first use
+     * 
+     * @param kind - TopicKind
+     * @param owner - sortic or box id, "+" for all boxes
+     * @return TopicHandle
+     */
+    TopicHandle getTopic(TopicKind kind, const String &owner);
+
+    /**
+     * @brief Get the name of an interned mqtt topic
+     * 
+     * @param handle - TopicHandle
+     * @return const String&
+     */
+    const String &getTopicName(TopicHandle handle) const;
+
+    /**
+     * @brief Subscribe a topic for a sortic, the broker is only asked for the first sortic
+     * 
+     * @param topics - topics of the sortic
+     * @param handle - TopicHandle
+     */
+    void subscribe(HubSubscriptions::TopicSet &topics, TopicHandle handle);
+
+    /**
+     * @brief Unsubscribe a topic of a sortic, the broker is only asked for the last sortic
+     * 
+     * @param topics - topics of the sortic
+     * @param handle - TopicHandle
+     */
+    void unsubscribe(HubSubscriptions::TopicSet &topics, TopicHandle handle);
+
+    /**
+     * @brief Replace the topics of a sortic, only the difference is sent
+     * 
+     * @param topics - topics of the sortic
+     * @param set - topics the sortic keeps
+     */
+    void setSubscriptions(HubSubscriptions::TopicSet &topics, const HubSubscriptions::TopicSet &set);
+
+    /**
+     * @brief Publish a message
+     * 
+     * @param topic - topic
+     * @param msg - serialized message
+     */
+    void publishMessage(const String &topic, const String &msg);
+
+    /**
+     * @brief Publish a message as CBOR
+     * 
+     * - if the client streams (MqttClientTraits::StreamingPublish) the encoder writes straight into its output,
+     *   the length is counted first, else the message goes through a stack buffer
+     * 
+     * @param topic - topic
+     * @param message - message to publish
+     * @return true 
+     * @return false - MessageCodec does not cover the message or the client cannot publish binary payloads, nothing was sent
+     */
+    bool publishBinary(const String &topic, const Message &message);
+
+    /**
+     * @brief Publish a binary payload
+     * 
+     * - if the client streams the payload is written into the output of the mqtt client
+     *   without a copy into a String, so it is not limited by the buffer of the client
+     * - else the client has to take the length, see MqttClientTraits
+     * 
+     * @param topic - topic
+     * @param payload - payload, may contain zero bytes
+     * @param length - length of the payload
+     * @return true 
+     * @return false - the client only publishes 0-terminated text, nothing was sent
+     */
+    bool publishPayload(const String &topic, const uint8_t *payload, size_t length);
+
+    /**
+     * @brief Get a new message id, the ids are unique over all sortics
+     * 
+     * - the sortics share one consignor in the messages, the receivers drop repeated ids
+     * 
+     * @return unsigned long long
+     */
+    unsigned long long nextMessageId();
+
+    /**
+     * @brief Get the index of the available boxes, it is kept across packages
+     * 
+     * @return HubBoxIndex&
+     */
+    HubBoxIndex &getBoxIndex();
+
+    /**
+     * @brief Ask the boxes to announce themselves again, call when the HubBoxIndex is stale
+     * 
+     * - sends the SUBSCRIBE of Box/+/available again, at most once per TIME_BETWEEN_SUBSCRIBE
+     * 
+     */
+    void refreshBoxes();
+
+    /**
+     * @brief Get the number of packages of other regions which wait for a box
+     * 
+     * @param region - own region of the asking sortic, its packages are not counted
+     * @return size_t - number of sortics which search a box for another region
+     */
+    size_t getWaitingPackages(const String &region) const;
+
+    /**
+     * @brief Count a package which arrived in a box
+     * 
+     * @param box - consignor of the box
+     */
+    void countSortedPackage(Consignor box);
+
+    /**
+     * @brief Get the number of packages the hub sorted into a box since it was free
+     * 
+     * @param box - consignor of the box
+     * @return unsigned int 
+     */
+    unsigned int getSortedPackages(Consignor box) const;
+
+    /**
+     * @brief Forget the sorted packages of a box, call when the box reports itself free
+     * 
+     * @param box - consignor of the box
+     */
+    void resetSortedPackages(Consignor box);
+
+    /**
+     * @brief MQTT callback function
+     * 
+     * - function will be used if a new message is available to receive and route the message
+     * 
+     * @param topic
+     * @param payload
+     * @param length
+     */
+    static void callback(char* topic, byte* payload, unsigned int length);
+
+    /**
+     * @brief Subscribe all topics of the sortics again
+     * 
+     * - called by task_probeMqtt() when the broker did not echo the probe,
+     *   a new broker session after a reconnect starts without subscriptions
+     * 
+     */
+    void resubscribe();
+
+    /**
+     * @brief Get the number of SUBSCRIBE and UNSUBSCRIBE requests which were not sent because nothing changed
+     * 
+     * @return unsigned long
+     */
+    unsigned long getSavedSubscriptionRequests() const;
+
+    /**
+     * @brief Get the number of received messages dropped as duplicate
+     * 
+     * @return unsigned long
+     */
+    unsigned long getDroppedDuplicates() const;
+
+    /**
+     * @brief Get the number of received messages dropped because the queue from the mqtt task was full
+     * 
+     * - always 0 without DUAL_CORE
+     * 
+     * @return unsigned long
+     */
+    unsigned long getDroppedInboxMessages() const;
+
+    /**
+     * @brief Get the number of times the FSM waited for a free slot in the command queue of the mqtt task
+     * 
+     * - always 0 without DUAL_CORE
+     * 
+     * @return unsigned long
+     */
+    unsigned long getMqttStalls() const;
+
+#ifdef TRACE_LOG
+    /**
+     * @brief Publish the records of the TraceLog ring as text on Sortic/hub/trace, call on demand
+     * 
+     * - the records are drained, the idle drain does not print them on Serial again
+     * - one payload holds up to TRACE_PUBLISH_SIZE bytes of whole lines
+     * 
+     * @return size_t - number of published records
+     */
+    size_t publishTrace();
+#endif
+
+    //======================PRIVATE==========================================================
+    private:
+
+    /**
+     * @brief Enum class holds all tasks of the scheduler
+     * 
+     */
+    enum class Task
+    {
+        PublishMetrics,
+        ProbeMqtt,
+        ServiceMqtt                     // keep last, used for TASK_COUNT
+    };
+
+    static constexpr size_t TASK_COUNT = (size_t)Task::ServiceMqtt + 1;    ///< number of tasks
+
+#ifdef DUAL_CORE
+    /**
+     * @brief Message received by the mqtt task and the topic it belongs to
+     * 
+     */
+    struct ReceivedMessage
+    {
+        TopicHandle handle = 0;                 ///< topic of the message
+        std::shared_ptr<Message> message;       ///< translated message
+    };
+#endif
+
+    /**
+     * @brief Task: deliver received mqtt messages to the sortics
+     * 
+     */
+    void task_serviceMqtt();
+
+    /**
+     * @brief Task: check the subscriptions with a probe on Sortic/hub/probe, which the hub subscribed itself
+     * 
+     * - the broker echoes the probe while the session holds the subscriptions, a probe which
+     *   was not echoed until the next one means the client lost its session, all topics are
+     *   subscribed again
+     * - works with any mqtt client, it only needs publishMessage() and subscribe()
+     * 
+     */
+    void task_probeMqtt();
+
+#ifdef HUB_METRICS
+    /**
+     * @brief Task: publish the histograms of the hub on Sortic/hub/metrics and start new ones
+     * 
+     * - the values mqtt/inboxDropped and mqtt/stalls count since the start of the hub
+     * 
+     */
+    void task_publishMetrics();
+#endif
+
+    /**
+     * @brief Drop duplicated messages and store the others at every sortic which subscribed the topic
+     * 
+     * - available box messages go to the HubBoxIndex of all sortics, a repeated one
+     *   still renews its box, the broker sends the retained message again on a refresh
+     * 
+     * @param handle - topic of the message
+     * @param message - translated message
+     */
+    void routeMessage(TopicHandle handle, const std::shared_ptr<Message> &message);
+
+    /**
+     * @brief Makes the hub the target of the mqtt callback, constructed before pComm
+     * 
+     * - the mqtt task of DUAL_CORE may call the callback as soon as pComm exists, the members
+     *   the callback uses are declared before pComm as well
+     * 
+     */
+    struct CallbackTarget
+    {
+        /**
+         * @brief Route the mqtt callback to a hub
+         * 
+         * @param hub - CommunicationHub
+         */
+        explicit CallbackTarget(CommunicationHub *hub);
+    };
+
+    HubTopicTable topicTable;                                                                           ///< interned mqtt topics
+    TopicHandle probeTopic = 0;                                                                         ///< Sortic/hub/probe, subscribed for the lifetime of the hub
+    std::atomic<bool> probeEchoed{true};                                                                ///< the last probe came back, set by the mqtt callback
+#ifdef DUAL_CORE
+    SpscQueue<ReceivedMessage, MQTT_INBOX_SIZE> mqttInbox;                                              ///< queue of received messages from the mqtt task
+    std::atomic<unsigned long> mqttInboxDropped{0};                                                     ///< number of received messages dropped because mqttInbox was full
+#endif
+    CallbackTarget callbackTarget{this};                                                                ///< routes the mqtt callback to this hub before pComm starts
+    MqttClient pComm{DEFAULT_HOSTNAME, &callback};                                                      ///< instance of mqtt communication
+    HubSubscriptions subscriptions = HubSubscriptions(pComm, topicTable);                               ///< subscriptions of pComm
+    DuplicateFilter<DUPLICATE_FILTER_CONSIGNORS, DUPLICATE_FILTER_TYPES> duplicateFilter;               ///< duplicate filter of the received messages
+    HubBoxIndex boxIndex = HubBoxIndex(BOX_AVAILABLE_EXPIRY);                                           ///< available boxes
+    HubSubscriptions::TopicSet hubTopics;                                                               ///< topics the hub subscribed for all sortics
+    TopicHandle boxAvailableTopic = 0;                                                                  ///< Box/+/available, subscribed for the lifetime of the hub
+    unsigned long lastBoxRefresh = 0;                                                                   ///< time of the last refreshBoxes()
+    bool boxRefreshed = false;                                                                          ///< refreshBoxes() was called once
+    TimerWheel<CommunicationHub, TASK_COUNT> scheduler = TimerWheel<CommunicationHub, TASK_COUNT>(this);   ///< periodic tasks
+    bool busy = false;                                                                                  ///< a sortic waits for mqtt messages
+    unsigned long long idCounter = 0;                                                                   ///< id counter to give every message a new id
+    unsigned int sortedPackages[BOX_CONSIGNORS] = {};                                                   ///< packages sorted into every box since it was free
+#ifdef HUB_METRICS
+    LatencyHistogram<METRICS_BUCKETS> loopHistogram;                                                    ///< time in us of one loop() pass
+    LatencyHistogram<METRICS_BUCKETS> mqttHistogram;                                                    ///< time in us the mqtt client is polled
+    unsigned long metricsSince = 0;                                                                     ///< time of the last metrics snapshot
+#endif
+    std::unique_ptr<CommunicationCtrl> sortics[SORTIC_COUNT];                                           ///< hosted sortics
+    size_t sorticCount = 0;                                                                             ///< number of hosted sortics
+};
+
+#endif // COMMUNICATIONHUB_H__
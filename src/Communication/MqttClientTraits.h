@@ -0,0 +1,120 @@
+/**
+ * @file MqttClientTraits.h
+ * @brief Compile time check which publish calls the mqtt client offers
+ * 
+ * The hub is built against different clients: SmartFactory_MQTTCommunication
+ * on the target, the stand-in of native/ on the host. A binary payload may
+ * contain zero bytes, it must not go through publishMessage(String, String)
+ * of a client which hands msg.c_str() on. It is only published if the client
+ * takes the length explicitly or streams it with beginPublish(), write() and
+ * endPublish() like PubSubClient.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+#ifndef MQTTCLIENTTRAITS_H__
+#define MQTTCLIENTTRAITS_H__
+
+#include <Arduino.h>
+#include <type_traits>
+#include <utility>
+
+#include "LogConfiguration.h"
+
+namespace MqttClientTraits
+{
+    /**
+     * @brief std::true_type if Client has publishMessage(const String &topic, const uint8_t *payload, size_t length)
+     * 
+     */
+    template <typename Client>
+    struct BinaryPublish
+    {
+        template <typename C>
+        static auto test(int) -> decltype(std::declval<C &>().publishMessage(std::declval<const String &>(), std::declval<const uint8_t *>(), size_t()), std::true_type());
+        template <typename C>
+        static std::false_type test(long);
+
+        typedef decltype(test<Client>(0)) type;     ///< std::true_type or std::false_type
+    };
+
+    /**
+     * @brief std::true_type if Client has beginPublish(const String &topic, size_t length), write(const uint8_t *data, size_t length) and endPublish()
+     * 
+     */
+    template <typename Client>
+    struct StreamingPublish
+    {
+        template <typename C>
+        static auto test(int) -> decltype(std::declval<C &>().beginPublish(std::declval<const String &>(), size_t()),
+                                          std::declval<C &>().write(std::declval<const uint8_t *>(), size_t()),
+                                          std::declval<C &>().endPublish(), std::true_type());
+        template <typename C>
+        static std::false_type test(long);
+
+        typedef decltype(test<Client>(0)) type;     ///< std::true_type or std::false_type
+    };
+
+    /**
+     * @brief Publish a binary payload with its length
+     * 
+     * @param client - client with publishMessage(topic, payload, length)
+     * @return true - the client took the payload
+     */
+    template <typename Client>
+    bool publishBytes(Client &client, const String &topic, const uint8_t *payload, size_t length, std::true_type)
+    {
+        client.publishMessage(topic, payload, length);
+        return true;
+    }
+
+    /**
+     * @brief Refuse a binary payload, the client only publishes 0-terminated text
+     * 
+     * @return false - nothing was sent
+     */
+    template <typename Client>
+    bool publishBytes(Client &, const String &, const uint8_t *, size_t, std::false_type)
+    {
+        return false;
+    }
+
+    /**
+     * @brief Stream a payload into the output of the client, the length is announced first
+     * 
+     * @param client - client with beginPublish(), write() and endPublish()
+     * @param writer - called with the client, writes exactly length bytes
+     * @return true - the publish was started
+     * @return false - the client refused beginPublish(), nothing was sent
+     */
+    template <typename Client, typename Writer>
+    bool streamPayload(Client &client, const String &topic, size_t length, const Writer &writer, std::true_type)
+    {
+        if (!client.beginPublish(topic, length))
+        {
+            return false;
+        }
+        writer(client);
+        if (!client.endPublish())
+        {
+            DBWARNINGln("Streamed publish failed");
+        }
+        return true;
+    }
+
+    /**
+     * @brief Refuse to stream, the client has no streaming publish
+     * 
+     * @return false - nothing was sent
+     */
+    template <typename Client, typename Writer>
+    bool streamPayload(Client &, const String &, size_t, const Writer &, std::false_type)
+    {
+        return false;
+    }
+}
+
+#endif // MQTTCLIENTTRAITS_H__
@@ -0,0 +1,155 @@
+/**
+ * @file MqttWorker.cpp
+ * @brief Runs the mqtt client in its own task on the other core
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include "MqttWorker.h"
+
+#include "LogConfiguration.h"
+
+#ifndef ARDUINO_ARCH_ESP32
+#include <chrono>
+#endif
+
+/**
+ * @brief Give the other task time to run
+ * 
+ * @param ms - time to wait, 0 only yields
+ */
+static void pause(unsigned long ms)
+{
+#ifdef ARDUINO_ARCH_ESP32
+    vTaskDelay(ms ? pdMS_TO_TICKS(ms) : 1);
+#else
+    if (ms)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+    else
+    {
+        std::this_thread::yield();
+    }
+#endif
+}
+
+MqttWorker::MqttWorker(String hostname, void (*callback)(char *topic, byte *payload, unsigned int length))
+    : client(hostname, callback)
+{
+    DBFUNCCALLln("MqttWorker::MqttWorker(String, void (*)(char*, byte*, unsigned int))");
+#ifdef ARDUINO_ARCH_ESP32
+    xTaskCreatePinnedToCore(&MqttWorker::task, "mqtt", MQTT_TASK_STACK, this, 1, nullptr, MQTT_TASK_CORE);
+#else
+    thread = std::thread(&MqttWorker::task, this);
+#endif
+}
+
+MqttWorker::~MqttWorker()
+{
+    DBFUNCCALLln("MqttWorker::~MqttWorker()");
+    running = false;
+#ifdef ARDUINO_ARCH_ESP32
+    while (!stopped)
+    {
+        pause(MQTT_TASK_PERIOD);
+    }
+#else
+    thread.join();
+#endif
+}
+
+void MqttWorker::subscribe(const String &topic)
+{
+    push(Command::Kind::Subscribe, topic, String());
+}
+
+void MqttWorker::unsubscribe(const String &topic)
+{
+    push(Command::Kind::Unsubscribe, topic, String());
+}
+
+void MqttWorker::publishMessage(const String &topic, const String &msg)
+{
+    push(Command::Kind::Publish, topic, msg);
+}
+
+bool MqttWorker::publishMessage(const String &topic, const uint8_t *payload, size_t length)
+{
+    if (!MqttClientTraits::BinaryPublish<Communication>::type::value)
+    {
+        return false;
+    }
+    Command *command = claim();
+    command->kind = Command::Kind::PublishBytes;
+    command->topic = topic;
+    command->bytes.assign(payload, payload + length);     // keeps the capacity of the slot
+    commands.endPush();
+    return true;
+}
+
+MqttWorker::Command *MqttWorker::claim()
+{
+    Command *command = commands.beginPush();
+    while (!command)
+    {
+        // a subscription must not get lost, wait for the mqtt task
+        stalls++;
+        DBWARNINGln("MQTT command queue full");
+        pause(0);
+        command = commands.beginPush();
+    }
+    return command;
+}
+
+void MqttWorker::push(Command::Kind kind, const String &topic, const String &payload)
+{
+    Command *command = claim();
+    command->kind = kind;
+    command->topic = topic;         // the slot keeps its storage, no allocation once warm
+    command->payload = payload;
+    commands.endPush();
+}
+
+void MqttWorker::run()
+{
+    for (Command *command = commands.front(); command; command = commands.front())
+    {
+        switch (command->kind)
+        {
+        case Command::Kind::Subscribe:
+            client.subscribe(command->topic);
+            break;
+        case Command::Kind::Unsubscribe:
+            client.unsubscribe(command->topic);
+            break;
+        case Command::Kind::Publish:
+            client.publishMessage(command->topic, command->payload);
+            break;
+        case Command::Kind::PublishBytes:
+            MqttClientTraits::publishBytes(client, command->topic, command->bytes.data(), command->bytes.size(),
+                                           MqttClientTraits::BinaryPublish<Communication>::type());
+            break;
+        }
+        commands.pop();
+    }
+    client.loop();
+}
+
+void MqttWorker::task(void *worker)
+{
+    MqttWorker *self = static_cast<MqttWorker *>(worker);
+    while (self->running)
+    {
+        self->run();
+        pause(MQTT_TASK_PERIOD);
+    }
+    self->stopped = true;
+#ifdef ARDUINO_ARCH_ESP32
+    vTaskDelete(nullptr);
+#endif
+}
@@ -0,0 +1,170 @@
+/**
+ * @file MqttWorker.h
+ * @brief Runs the mqtt client in its own task on the other core
+ * 
+ * The worker owns the client. Subscribe, unsubscribe and publish requests of
+ * the FSM are queued as commands and executed by the mqtt task, which also
+ * polls the client. The callback is called by the mqtt task, it has to hand
+ * the messages to the FSM through a queue as well.
+ * 
+ * On the ESP32 the task is a FreeRTOS task pinned to MQTT_TASK_CORE, on the
+ * host a std::thread.
+ * 
+ * @version 1.0
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#ifndef MQTTWORKER_H__
+#define MQTTWORKER_H__
+
+#include <Arduino.h>
+#include <atomic>
+#include <vector>
+#ifndef ARDUINO_ARCH_ESP32
+#include <thread>
+#endif
+
+#include "MainConfiguration.h"
+#include "MQTTCommunication.h"
+#include "MqttClientTraits.h"
+#include "SpscQueue.h"
+
+/**
+ * @brief Mqtt client running in its own task
+ * 
+ * - the interface matches the part of Communication the FSM uses
+ * - the FSM is the only producer of commands, the mqtt task the only consumer
+ * 
+ */
+class MqttWorker
+{
+    //======================PUBLIC===========================================================
+    public:
+
+    /**
+     * @brief Construct a new Mqtt Worker object, connect the client and start the mqtt task
+     * 
+     * @param hostname - client name
+     * @param callback - called by the mqtt task for every received message
+     */
+    MqttWorker(String hostname, void (*callback)(char *topic, byte *payload, unsigned int length));
+
+    /**
+     * @brief Stop the mqtt task and destroy the client
+     * 
+     */
+    ~MqttWorker();
+
+    MqttWorker(const MqttWorker &) = delete;
+    MqttWorker &operator=(const MqttWorker &) = delete;
+
+    /**
+     * @brief Queue a subscription
+     * 
+     * @param topic 
+     */
+    void subscribe(const String &topic);
+
+    /**
+     * @brief Queue an unsubscription
+     * 
+     * @param topic 
+     */
+    void unsubscribe(const String &topic);
+
+    /**
+     * @brief Queue a message to publish
+     * 
+     * @param topic 
+     * @param msg 
+     */
+    void publishMessage(const String &topic, const String &msg);
+
+    /**
+     * @brief Queue a binary payload to publish, only if the client takes its length
+     * 
+     * @param topic 
+     * @param payload - payload, may contain zero bytes
+     * @param length - length of the payload
+     * @return true 
+     * @return false - the client only publishes 0-terminated text, nothing was queued
+     */
+    bool publishMessage(const String &topic, const uint8_t *payload, size_t length);
+
+    /**
+     * @brief Get the number of times the FSM had to wait because the command queue was full
+     * 
+     * @return unsigned long 
+     */
+    unsigned long getStalls() const { return stalls; }
+
+    //======================PRIVATE==========================================================
+    private:
+
+    /**
+     * @brief Request of the FSM to the mqtt client
+     * 
+     */
+    struct Command
+    {
+        /**
+         * @brief Enum class holds the kinds of commands
+         * 
+         */
+        enum class Kind : uint8_t
+        {
+            Subscribe,
+            Unsubscribe,
+            Publish,
+            PublishBytes
+        };
+
+        Kind kind = Kind::Publish;      ///< kind of the command
+        String topic;                   ///< topic of the command
+        String payload;                 ///< message of a publish
+        std::vector<uint8_t> bytes;     ///< payload of a binary publish
+    };
+
+    /**
+     * @brief Queue a command, waits while the queue is full
+     * 
+     * @param kind - Command::Kind
+     * @param topic 
+     * @param payload 
+     */
+    void push(Command::Kind kind, const String &topic, const String &payload);
+
+    /**
+     * @brief Wait for a free command slot
+     * 
+     * @return Command* - slot to fill, commands.endPush() queues it
+     */
+    Command *claim();
+
+    /**
+     * @brief Execute the queued commands and poll the client, called by the mqtt task
+     * 
+     */
+    void run();
+
+    /**
+     * @brief Body of the mqtt task
+     * 
+     * @param worker - MqttWorker
+     */
+    static void task(void *worker);
+
+    Communication client;                                           ///< mqtt client, only used by the mqtt task after construction
+    SpscQueue<Command, MQTT_COMMAND_QUEUE_SIZE> commands;           ///< commands of the FSM to the mqtt task
+    std::atomic<bool> running{true};                                ///< mqtt task keeps running
+    std::atomic<bool> stopped{false};                               ///< mqtt task has finished
+    unsigned long stalls = 0;                                       ///< number of waits for a free command slot
+#ifndef ARDUINO_ARCH_ESP32
+    std::thread thread;                                             ///< mqtt task on the host
+#endif
+};
+
+#endif // MQTTWORKER_H__
@@ -1,19 +1,19 @@
 #include <Arduino.h>
-#include "CommunicationCtrl.h"
+#include "CommunicationHub.h"
 
 #define MASTER
 
-CommunicationCtrl *communicate;
+CommunicationHub *communicate;
 
 void setup() 
 {
   Serial.begin(9600);
-  communicate = new CommunicationCtrl();
+  communicate = new CommunicationHub();     // hosts SORTIC_COUNT sortics
   
 }
 
 
 void loop() 
 {
-  communicate->loop();
+  delay(communicate->loop());   // sleep until the communication hub has work again
 }
\ No newline at end of file